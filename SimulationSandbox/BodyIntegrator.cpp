@@ -0,0 +1,272 @@
+#include "BodyIntegrator.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BODY_INTEGRATOR_X86 1
+#include <immintrin.h>
+#endif
+
+// MSVC accepts every intrinsic anywhere; GCC and Clang need the target per function
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SIMD_TARGET(isa)
+#endif
+
+// The scalar tail of a chunk must round exactly like the lanes, as the chunk bounds move with the
+// thread count: no a * b + c may become an FMA.
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#elif defined(_MSC_VER)
+#pragma fp_contract(off)
+#endif
+
+namespace
+{
+	const float radiansToDegrees = 180.0f / DirectX::XM_PI;
+	const float spinScale = 0.1f; // the rendered spin is slowed down, as in Collider
+
+	// Gravity is the only force and it is constant over the step, so every method has a closed
+	// form: the velocity gains gravity * dt and the position moves by velocity * dt plus this
+	// factor times gravity * dt * dt.
+	template <IntegrationMethod Method>
+	constexpr float gravityFactor()
+	{
+		if constexpr (Method == IntegrationMethod::SEMI_IMPLICIT_EULER)
+		{
+			return 1.0f; // the position moves with the new velocity
+		}
+		else
+		{
+			// RK4 is exact for constant acceleration, and so are midpoint and velocity Verlet,
+			// which only differ from it once a force depends on the position; see setLevel
+			return 0.5f;
+		}
+	}
+
+	bool isMoving(uint8_t flags)
+	{
+		return (flags & (BODY_OWNED | BODY_SLEEPING)) == BODY_OWNED;
+	}
+
+	template <IntegrationMethod Method>
+	void integrateBody(BodyStore& bodies, int i, float dt, float gravity)
+	{
+		float velocityY = bodies.velY[i];
+		bodies.posX[i] += bodies.velX[i] * dt;
+		bodies.posY[i] += velocityY * dt + gravityFactor<Method>() * gravity * dt * dt;
+		bodies.posZ[i] += bodies.velZ[i] * dt;
+		velocityY += gravity * dt;
+
+		float velocityX = bodies.velX[i] * BodyIntegrator::LINEAR_DAMPING;
+		velocityY *= BodyIntegrator::LINEAR_DAMPING;
+		float velocityZ = bodies.velZ[i] * BodyIntegrator::LINEAR_DAMPING;
+		float angularX = bodies.angVelX[i] * BodyIntegrator::ANGULAR_DAMPING;
+		float angularY = bodies.angVelY[i] * BodyIntegrator::ANGULAR_DAMPING;
+		float angularZ = bodies.angVelZ[i] * BodyIntegrator::ANGULAR_DAMPING;
+
+		// The slowest bodies are stopped to prevent jittering
+		const float restSpeedSq = BodyIntegrator::REST_SPEED * BodyIntegrator::REST_SPEED;
+		if (velocityX * velocityX + velocityY * velocityY + velocityZ * velocityZ < restSpeedSq &&
+			angularX * angularX + angularY * angularY + angularZ * angularZ < restSpeedSq)
+		{
+			velocityX = velocityY = velocityZ = 0.0f;
+			angularX = angularY = angularZ = 0.0f;
+		}
+
+		if (bodies.inverseInertia[i] > 0.0f)
+		{
+			const float spin = dt * spinScale * radiansToDegrees;
+			bodies.rotX[i] += angularX * spin;
+			bodies.rotY[i] += angularY * spin;
+			bodies.rotZ[i] += angularZ * spin;
+		}
+
+		bodies.velX[i] = velocityX; bodies.velY[i] = velocityY; bodies.velZ[i] = velocityZ;
+		bodies.angVelX[i] = angularX; bodies.angVelY[i] = angularY; bodies.angVelZ[i] = angularZ;
+	}
+
+	template <IntegrationMethod Method>
+	void integrateScalar(BodyStore& bodies, int begin, int end, float dt, float gravity)
+	{
+		for (int i = begin; i < end; ++i)
+		{
+			if (isMoving(bodies.flags[i])) integrateBody<Method>(bodies, i, dt, gravity);
+		}
+	}
+
+#ifdef BODY_INTEGRATOR_X86
+	template <IntegrationMethod Method>
+	SIMD_TARGET("sse2")
+	void integrateSSE(BodyStore& bodies, int begin, int end, float dt, float gravity)
+	{
+		const __m128 step = _mm_set1_ps(dt);
+		const __m128 velocityGain = _mm_set1_ps(gravity * dt);
+		const __m128 positionGain = _mm_set1_ps(gravityFactor<Method>() * gravity * dt * dt);
+		const __m128 linearDamping = _mm_set1_ps(BodyIntegrator::LINEAR_DAMPING);
+		const __m128 angularDamping = _mm_set1_ps(BodyIntegrator::ANGULAR_DAMPING);
+		const __m128 restSpeedSq = _mm_set1_ps(BodyIntegrator::REST_SPEED * BodyIntegrator::REST_SPEED);
+		const __m128 spin = _mm_set1_ps(dt * spinScale * radiansToDegrees);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128i flagMask = _mm_set1_epi32(BODY_OWNED | BODY_SLEEPING);
+		const __m128i movingFlags = _mm_set1_epi32(BODY_OWNED);
+
+		// SSE2 has no blend, the lanes of bodies that do not move keep their old values
+		auto select = [](__m128 mask, __m128 updated, __m128 original)
+			{
+				return _mm_or_ps(_mm_and_ps(mask, updated), _mm_andnot_ps(mask, original));
+			};
+
+		int i = begin;
+		for (; i + 4 <= end; i += 4)
+		{
+			int packedFlags;
+			memcpy(&packedFlags, &bodies.flags[i], sizeof(packedFlags));
+			__m128i flags = _mm_cvtsi32_si128(packedFlags);
+			flags = _mm_unpacklo_epi16(_mm_unpacklo_epi8(flags, _mm_setzero_si128()), _mm_setzero_si128());
+			const __m128 moving = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(flags, flagMask), movingFlags));
+			if (_mm_movemask_ps(moving) == 0) continue;
+
+			const __m128 posX = _mm_loadu_ps(&bodies.posX[i]);
+			const __m128 posY = _mm_loadu_ps(&bodies.posY[i]);
+			const __m128 posZ = _mm_loadu_ps(&bodies.posZ[i]);
+			const __m128 velX = _mm_loadu_ps(&bodies.velX[i]);
+			const __m128 velY = _mm_loadu_ps(&bodies.velY[i]);
+			const __m128 velZ = _mm_loadu_ps(&bodies.velZ[i]);
+			const __m128 angX = _mm_loadu_ps(&bodies.angVelX[i]);
+			const __m128 angY = _mm_loadu_ps(&bodies.angVelY[i]);
+			const __m128 angZ = _mm_loadu_ps(&bodies.angVelZ[i]);
+
+			_mm_storeu_ps(&bodies.posX[i], select(moving, _mm_add_ps(posX, _mm_mul_ps(velX, step)), posX));
+			_mm_storeu_ps(&bodies.posY[i], select(moving, _mm_add_ps(posY, _mm_add_ps(_mm_mul_ps(velY, step), positionGain)), posY));
+			_mm_storeu_ps(&bodies.posZ[i], select(moving, _mm_add_ps(posZ, _mm_mul_ps(velZ, step)), posZ));
+
+			__m128 newVelX = _mm_mul_ps(velX, linearDamping);
+			__m128 newVelY = _mm_mul_ps(_mm_add_ps(velY, velocityGain), linearDamping);
+			__m128 newVelZ = _mm_mul_ps(velZ, linearDamping);
+			__m128 newAngX = _mm_mul_ps(angX, angularDamping);
+			__m128 newAngY = _mm_mul_ps(angY, angularDamping);
+			__m128 newAngZ = _mm_mul_ps(angZ, angularDamping);
+
+			const __m128 linearSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(newVelX, newVelX), _mm_mul_ps(newVelY, newVelY)), _mm_mul_ps(newVelZ, newVelZ));
+			const __m128 angularSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(newAngX, newAngX), _mm_mul_ps(newAngY, newAngY)), _mm_mul_ps(newAngZ, newAngZ));
+			const __m128 keep = _mm_or_ps(_mm_cmpge_ps(linearSq, restSpeedSq), _mm_cmpge_ps(angularSq, restSpeedSq));
+			newVelX = _mm_and_ps(keep, newVelX); newVelY = _mm_and_ps(keep, newVelY); newVelZ = _mm_and_ps(keep, newVelZ);
+			newAngX = _mm_and_ps(keep, newAngX); newAngY = _mm_and_ps(keep, newAngY); newAngZ = _mm_and_ps(keep, newAngZ);
+
+			const __m128 spinning = _mm_and_ps(moving, _mm_cmpgt_ps(_mm_loadu_ps(&bodies.inverseInertia[i]), zero));
+			const __m128 rotX = _mm_loadu_ps(&bodies.rotX[i]);
+			const __m128 rotY = _mm_loadu_ps(&bodies.rotY[i]);
+			const __m128 rotZ = _mm_loadu_ps(&bodies.rotZ[i]);
+			_mm_storeu_ps(&bodies.rotX[i], select(spinning, _mm_add_ps(rotX, _mm_mul_ps(newAngX, spin)), rotX));
+			_mm_storeu_ps(&bodies.rotY[i], select(spinning, _mm_add_ps(rotY, _mm_mul_ps(newAngY, spin)), rotY));
+			_mm_storeu_ps(&bodies.rotZ[i], select(spinning, _mm_add_ps(rotZ, _mm_mul_ps(newAngZ, spin)), rotZ));
+
+			_mm_storeu_ps(&bodies.velX[i], select(moving, newVelX, velX));
+			_mm_storeu_ps(&bodies.velY[i], select(moving, newVelY, velY));
+			_mm_storeu_ps(&bodies.velZ[i], select(moving, newVelZ, velZ));
+			_mm_storeu_ps(&bodies.angVelX[i], select(moving, newAngX, angX));
+			_mm_storeu_ps(&bodies.angVelY[i], select(moving, newAngY, angY));
+			_mm_storeu_ps(&bodies.angVelZ[i], select(moving, newAngZ, angZ));
+		}
+		integrateScalar<Method>(bodies, i, end, dt, gravity);
+	}
+
+	template <IntegrationMethod Method>
+	SIMD_TARGET("avx2")
+	void integrateAVX2(BodyStore& bodies, int begin, int end, float dt, float gravity)
+	{
+		const __m256 step = _mm256_set1_ps(dt);
+		const __m256 velocityGain = _mm256_set1_ps(gravity * dt);
+		const __m256 positionGain = _mm256_set1_ps(gravityFactor<Method>() * gravity * dt * dt);
+		const __m256 linearDamping = _mm256_set1_ps(BodyIntegrator::LINEAR_DAMPING);
+		const __m256 angularDamping = _mm256_set1_ps(BodyIntegrator::ANGULAR_DAMPING);
+		const __m256 restSpeedSq = _mm256_set1_ps(BodyIntegrator::REST_SPEED * BodyIntegrator::REST_SPEED);
+		const __m256 spin = _mm256_set1_ps(dt * spinScale * radiansToDegrees);
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256i flagMask = _mm256_set1_epi32(BODY_OWNED | BODY_SLEEPING);
+		const __m256i movingFlags = _mm256_set1_epi32(BODY_OWNED);
+
+		int i = begin;
+		for (; i + 8 <= end; i += 8)
+		{
+			const __m256i flags = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&bodies.flags[i])));
+			const __m256 moving = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(flags, flagMask), movingFlags));
+			if (_mm256_movemask_ps(moving) == 0) continue;
+
+			const __m256 posX = _mm256_loadu_ps(&bodies.posX[i]);
+			const __m256 posY = _mm256_loadu_ps(&bodies.posY[i]);
+			const __m256 posZ = _mm256_loadu_ps(&bodies.posZ[i]);
+			const __m256 velX = _mm256_loadu_ps(&bodies.velX[i]);
+			const __m256 velY = _mm256_loadu_ps(&bodies.velY[i]);
+			const __m256 velZ = _mm256_loadu_ps(&bodies.velZ[i]);
+			const __m256 angX = _mm256_loadu_ps(&bodies.angVelX[i]);
+			const __m256 angY = _mm256_loadu_ps(&bodies.angVelY[i]);
+			const __m256 angZ = _mm256_loadu_ps(&bodies.angVelZ[i]);
+
+			_mm256_storeu_ps(&bodies.posX[i], _mm256_blendv_ps(posX, _mm256_add_ps(posX, _mm256_mul_ps(velX, step)), moving));
+			_mm256_storeu_ps(&bodies.posY[i], _mm256_blendv_ps(posY, _mm256_add_ps(posY, _mm256_add_ps(_mm256_mul_ps(velY, step), positionGain)), moving));
+			_mm256_storeu_ps(&bodies.posZ[i], _mm256_blendv_ps(posZ, _mm256_add_ps(posZ, _mm256_mul_ps(velZ, step)), moving));
+
+			__m256 newVelX = _mm256_mul_ps(velX, linearDamping);
+			__m256 newVelY = _mm256_mul_ps(_mm256_add_ps(velY, velocityGain), linearDamping);
+			__m256 newVelZ = _mm256_mul_ps(velZ, linearDamping);
+			__m256 newAngX = _mm256_mul_ps(angX, angularDamping);
+			__m256 newAngY = _mm256_mul_ps(angY, angularDamping);
+			__m256 newAngZ = _mm256_mul_ps(angZ, angularDamping);
+
+			const __m256 linearSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(newVelX, newVelX), _mm256_mul_ps(newVelY, newVelY)), _mm256_mul_ps(newVelZ, newVelZ));
+			const __m256 angularSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(newAngX, newAngX), _mm256_mul_ps(newAngY, newAngY)), _mm256_mul_ps(newAngZ, newAngZ));
+			const __m256 keep = _mm256_or_ps(_mm256_cmp_ps(linearSq, restSpeedSq, _CMP_GE_OQ), _mm256_cmp_ps(angularSq, restSpeedSq, _CMP_GE_OQ));
+			newVelX = _mm256_and_ps(keep, newVelX); newVelY = _mm256_and_ps(keep, newVelY); newVelZ = _mm256_and_ps(keep, newVelZ);
+			newAngX = _mm256_and_ps(keep, newAngX); newAngY = _mm256_and_ps(keep, newAngY); newAngZ = _mm256_and_ps(keep, newAngZ);
+
+			const __m256 spinning = _mm256_and_ps(moving, _mm256_cmp_ps(_mm256_loadu_ps(&bodies.inverseInertia[i]), zero, _CMP_GT_OQ));
+			const __m256 rotX = _mm256_loadu_ps(&bodies.rotX[i]);
+			const __m256 rotY = _mm256_loadu_ps(&bodies.rotY[i]);
+			const __m256 rotZ = _mm256_loadu_ps(&bodies.rotZ[i]);
+			_mm256_storeu_ps(&bodies.rotX[i], _mm256_blendv_ps(rotX, _mm256_add_ps(rotX, _mm256_mul_ps(newAngX, spin)), spinning));
+			_mm256_storeu_ps(&bodies.rotY[i], _mm256_blendv_ps(rotY, _mm256_add_ps(rotY, _mm256_mul_ps(newAngY, spin)), spinning));
+			_mm256_storeu_ps(&bodies.rotZ[i], _mm256_blendv_ps(rotZ, _mm256_add_ps(rotZ, _mm256_mul_ps(newAngZ, spin)), spinning));
+
+			_mm256_storeu_ps(&bodies.velX[i], _mm256_blendv_ps(velX, newVelX, moving));
+			_mm256_storeu_ps(&bodies.velY[i], _mm256_blendv_ps(velY, newVelY, moving));
+			_mm256_storeu_ps(&bodies.velZ[i], _mm256_blendv_ps(velZ, newVelZ, moving));
+			_mm256_storeu_ps(&bodies.angVelX[i], _mm256_blendv_ps(angX, newAngX, moving));
+			_mm256_storeu_ps(&bodies.angVelY[i], _mm256_blendv_ps(angY, newAngY, moving));
+			_mm256_storeu_ps(&bodies.angVelZ[i], _mm256_blendv_ps(angZ, newAngZ, moving));
+		}
+		integrateScalar<Method>(bodies, i, end, dt, gravity);
+	}
+#endif
+
+	template <IntegrationMethod Method>
+	BodyIntegrator::Kernel getKernel(SimdLevel level)
+	{
+		switch (level)
+		{
+#ifdef BODY_INTEGRATOR_X86
+		case SimdLevel::AVX512:
+		case SimdLevel::AVX2: return integrateAVX2<Method>;
+		case SimdLevel::SSE: return integrateSSE<Method>;
+#endif
+		default: return integrateScalar<Method>;
+		}
+	}
+}
+
+void BodyIntegrator::setLevel(SimdLevel level)
+{
+	if (static_cast<int>(level) > static_cast<int>(SphereNarrowphase::getSupportedLevel())) level = SphereNarrowphase::getSupportedLevel();
+	_level = level;
+
+	_kernels[static_cast<int>(IntegrationMethod::SEMI_IMPLICIT_EULER)] = getKernel<IntegrationMethod::SEMI_IMPLICIT_EULER>(level);
+	_kernels[static_cast<int>(IntegrationMethod::RK4)] = getKernel<IntegrationMethod::RK4>(level);
+
+	// Under gravity alone these step exactly like RK4, so they share its kernels
+	_kernels[static_cast<int>(IntegrationMethod::MIDPOINT)] = _kernels[static_cast<int>(IntegrationMethod::RK4)];
+	_kernels[static_cast<int>(IntegrationMethod::VERLET)] = _kernels[static_cast<int>(IntegrationMethod::RK4)];
+}
@@ -0,0 +1,120 @@
+#include "BodyStore.h"
+#include "Sphere.h"
+
+namespace
+{
+	template <typename T>
+	void permute(std::vector<T>& values, const std::vector<int>& order)
+	{
+		std::vector<T> reordered(values.size());
+		for (size_t k = 0; k < order.size(); ++k)
+		{
+			reordered[k] = values[order[k]];
+		}
+		values.swap(reordered);
+	}
+}
+
+int BodyStore::add(PhysicsObject& obj)
+{
+	const int index = static_cast<int>(size());
+
+	const DirectX::XMFLOAT3 position = obj.getPosition();
+	const DirectX::XMFLOAT3 rotation = obj.getRotation();
+	const DirectX::XMFLOAT3& velocity = obj.getVelocity();
+	const DirectX::XMFLOAT3& angularVelocity = obj.getAngularVelocity();
+
+	posX.push_back(position.x); posY.push_back(position.y); posZ.push_back(position.z);
+	velX.push_back(velocity.x); velY.push_back(velocity.y); velZ.push_back(velocity.z);
+	angVelX.push_back(angularVelocity.x); angVelY.push_back(angularVelocity.y); angVelZ.push_back(angularVelocity.z);
+	rotX.push_back(rotation.x); rotY.push_back(rotation.y); rotZ.push_back(rotation.z);
+
+	// Moving bodies are always spheres; anything else falls back to its x scale as a bounding radius.
+	const Collider* collider = obj.getColliderPtr();
+	const bool isSphere = collider && collider->getShapeType() == ShapeType::SPHERE;
+	radius.push_back(isSphere ? static_cast<const Sphere*>(collider)->getRadius() : obj.getScale().x);
+	inverseMass.push_back(obj.getInverseMass());
+	inverseInertia.push_back(obj.getInverseMomentOfInertia());
+	material.push_back(obj.getMaterial());
+	quietTime.push_back(0.0f);
+	restX.push_back(position.x); restY.push_back(position.y); restZ.push_back(position.z);
+
+	const ConstantBuffer constantBuffer = obj.getConstantBuffer();
+	lightColour.push_back(constantBuffer.LightColour);
+	darkColour.push_back(constantBuffer.DarkColour);
+
+	owner.push_back(obj.getPeerID());
+	objectId.push_back(obj.getObjectId());
+	flags.push_back(obj.isOwned() ? BODY_OWNED : 0);
+	objects.push_back(&obj);
+
+	obj.setBodyIndex(index);
+	return index;
+}
+
+void BodyStore::clear()
+{
+	for (PhysicsObject* obj : objects)
+	{
+		if (obj) obj->setBodyIndex(-1);
+	}
+
+	posX.clear(); posY.clear(); posZ.clear();
+	velX.clear(); velY.clear(); velZ.clear();
+	angVelX.clear(); angVelY.clear(); angVelZ.clear();
+	rotX.clear(); rotY.clear(); rotZ.clear();
+	radius.clear();
+	inverseMass.clear();
+	inverseInertia.clear();
+	material.clear();
+	quietTime.clear();
+	restX.clear(); restY.clear(); restZ.clear();
+	lightColour.clear(); darkColour.clear();
+	owner.clear();
+	objectId.clear();
+	flags.clear();
+	objects.clear();
+}
+
+void BodyStore::reserve(size_t count)
+{
+	posX.reserve(count); posY.reserve(count); posZ.reserve(count);
+	velX.reserve(count); velY.reserve(count); velZ.reserve(count);
+	angVelX.reserve(count); angVelY.reserve(count); angVelZ.reserve(count);
+	rotX.reserve(count); rotY.reserve(count); rotZ.reserve(count);
+	radius.reserve(count);
+	inverseMass.reserve(count);
+	inverseInertia.reserve(count);
+	material.reserve(count);
+	quietTime.reserve(count);
+	restX.reserve(count); restY.reserve(count); restZ.reserve(count);
+	lightColour.reserve(count); darkColour.reserve(count);
+	owner.reserve(count);
+	objectId.reserve(count);
+	flags.reserve(count);
+	objects.reserve(count);
+}
+
+void BodyStore::reorder(const std::vector<int>& order)
+{
+	permute(posX, order); permute(posY, order); permute(posZ, order);
+	permute(velX, order); permute(velY, order); permute(velZ, order);
+	permute(angVelX, order); permute(angVelY, order); permute(angVelZ, order);
+	permute(rotX, order); permute(rotY, order); permute(rotZ, order);
+	permute(radius, order);
+	permute(inverseMass, order);
+	permute(inverseInertia, order);
+	permute(material, order);
+	permute(quietTime, order);
+	permute(restX, order); permute(restY, order); permute(restZ, order);
+	permute(lightColour, order); permute(darkColour, order);
+	permute(owner, order);
+	permute(objectId, order);
+	permute(flags, order);
+	permute(objects, order);
+
+	for (size_t i = 0; i < objects.size(); ++i)
+	{
+		objects[i]->setBodyIndex(static_cast<int>(i));
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <DirectXMath.h>
+#include "PhysicsObject.h"
+
+// Per-body flag bits stored in BodyStore::flags
+enum BodyFlags : uint8_t
+{
+	BODY_OWNED = 1 << 0,    // simulated by this peer, otherwise state comes from the network
+	BODY_SLEEPING = 1 << 1, // at rest: not integrated, tested or published until woken
+};
+
+// Contiguous structure-of-arrays storage for every moving body.
+// The simulation threads only ever iterate these arrays; the renderer reads the world
+// snapshot taken from them at the end of every tick.
+struct BodyStore
+{
+	// --- Kinematic State ---
+	std::vector<float> posX, posY, posZ;
+	std::vector<float> velX, velY, velZ;
+	std::vector<float> angVelX, angVelY, angVelZ;
+	std::vector<float> rotX, rotY, rotZ; // euler angles in degrees, same as Collider
+
+	// --- Shape and Mass ---
+	std::vector<float> radius;
+	std::vector<float> inverseMass;
+	std::vector<float> inverseInertia;
+	std::vector<Material> material;
+
+	// --- Sleeping ---
+	std::vector<float> quietTime;            // seconds the body has been slow and near its rest position
+	std::vector<float> restX, restY, restZ; // where the body was when it became slow
+
+	// --- Rendering ---
+	std::vector<DirectX::XMFLOAT4> lightColour, darkColour; // copied into the world snapshot
+
+	// --- Ownership ---
+	std::vector<int> owner; // peer id
+	std::vector<int> objectId;
+	std::vector<uint8_t> flags;
+	std::vector<PhysicsObject*> objects;
+
+	size_t size() const { return objects.size(); }
+	bool empty() const { return objects.empty(); }
+
+	int add(PhysicsObject& obj);
+	void clear();
+	void reserve(size_t count);
+	// Moves body order[k] to slot k for every k and updates the objects' body indices
+	void reorder(const std::vector<int>& order);
+
+	bool isOwned(size_t i) const { return (flags[i] & BODY_OWNED) != 0; }
+	bool isSleeping(size_t i) const { return (flags[i] & BODY_SLEEPING) != 0; }
+	DirectX::XMFLOAT3 getPosition(size_t i) const { return { posX[i], posY[i], posZ[i] }; }
+	DirectX::XMFLOAT3 getVelocity(size_t i) const { return { velX[i], velY[i], velZ[i] }; }
+	DirectX::XMFLOAT3 getRotation(size_t i) const { return { rotX[i], rotY[i], rotZ[i] }; }
+};
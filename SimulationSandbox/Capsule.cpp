@@ -1,6 +1,6 @@
 #include "Capsule.h"
-#include "Sphere.h"
 #include <algorithm>
+#include <cmath>
 
 using namespace DirectX;
 
@@ -28,24 +28,17 @@ DirectX::XMFLOAT3 Capsule::getAxis() const
 	return result;
 }
 
-bool Capsule::isColliding(const Collider& other, DirectX::XMFLOAT3& outNormal, float& penetrationDepth) const
+bool Capsule::getBounds(DirectX::XMFLOAT3& outMin, DirectX::XMFLOAT3& outMax) const
 {
-	// Check if the other collider is a sphere.
-	if (const Sphere* sphere = dynamic_cast<const Sphere*>(&other)) {
-		// Delegate the collision check to the sphere class.
-		bool result = sphere->isCollidingWithCapsule(*this, outNormal, penetrationDepth);
-
-		// The normal returned by the sphere points from the capsule to the sphere.
-		// For consistency, we invert it so it points from the sphere towards our capsule.
-		if (result)
-		{
-			outNormal.x = -outNormal.x;
-			outNormal.y = -outNormal.y;
-			outNormal.z = -outNormal.z;
-		}
-		return result;
-	}
-
-	// For any other type of collider, do nothing.
-	return false;
-}
\ No newline at end of file
+	// Box around the central segment, grown by the radius
+	XMFLOAT3 axis = getAxis();
+	const XMFLOAT3& center = getPosition();
+	float halfHeight = getHeight() * 0.5f;
+	float extentX = fabsf(axis.x) * halfHeight + getRadius();
+	float extentY = fabsf(axis.y) * halfHeight + getRadius();
+	float extentZ = fabsf(axis.z) * halfHeight + getRadius();
+
+	outMin = { center.x - extentX, center.y - extentY, center.z - extentZ };
+	outMax = { center.x + extentX, center.y + extentY, center.z + extentZ };
+	return true;
+}
@@ -14,13 +14,13 @@ public:
 		DirectX::XMFLOAT3 position = { 0.0f, 0.0f, 0.0f },
 		DirectX::XMFLOAT3 rotation = { 0.0f, 0.0f, 0.0f },
 		DirectX::XMFLOAT3 scale = { 1.0f, 1.0f, 1.0f })
-		: Collider(position, rotation, scale)
+		: Collider(ShapeType::CAPSULE, position, rotation, scale)
 	{
 		updateDimensions();
 	}
 	~Capsule() = default;
 
-	bool isColliding(const Collider& other, DirectX::XMFLOAT3& outNormal, float& penetrationDepth) const override;
+	bool getBounds(DirectX::XMFLOAT3& outMin, DirectX::XMFLOAT3& outMax) const override;
 
 	float getRadius() const { return _radius; }
 	float getHeight() const { return _height; }
@@ -0,0 +1,69 @@
+#include "CellSort.h"
+
+void CellSort::init(size_t numCells, int numThreads)
+{
+	_cellStart.assign(numCells, 0);
+	_cellCount.assign(numCells, 0);
+	_sortedItems.clear();
+
+	// Histograms keep their storage, so callers with a changing cell count can init every build
+	numThreads = std::max(1, numThreads);
+	_threadHistograms.resize(numThreads);
+	for (auto& histogram : _threadHistograms)
+	{
+		histogram.assign(numCells, 0);
+	}
+	_threadCellTotals.assign(numThreads, 0);
+}
+
+void CellSort::getCellRange(int threadIndex, int numThreads, int& startCell, int& endCell) const
+{
+	const int totalCells = static_cast<int>(_cellCount.size());
+	const int cellsPerThread = (totalCells + numThreads - 1) / numThreads;
+	startCell = std::min(threadIndex * cellsPerThread, totalCells);
+	endCell = std::min(startCell + cellsPerThread, totalCells);
+}
+
+void CellSort::sumCells(int threadIndex, int numThreads)
+{
+	int startCell, endCell;
+	getCellRange(threadIndex, numThreads, startCell, endCell);
+
+	int total = 0;
+	for (int cell = startCell; cell < endCell; ++cell)
+	{
+		int count = 0;
+		for (const auto& histogram : _threadHistograms)
+		{
+			count += histogram[cell];
+		}
+		_cellCount[cell] = count;
+		total += count;
+	}
+	_threadCellTotals[threadIndex] = total;
+}
+
+void CellSort::assignOffsets(int threadIndex, int numThreads)
+{
+	int startCell, endCell;
+	getCellRange(threadIndex, numThreads, startCell, endCell);
+
+	int offset = 0;
+	for (int t = 0; t < threadIndex; ++t)
+	{
+		offset += _threadCellTotals[t];
+	}
+
+	// Cursors are handed out in thread order, and threads own ascending item ranges,
+	// so every cell lists its items in ascending index order.
+	for (int cell = startCell; cell < endCell; ++cell)
+	{
+		_cellStart[cell] = offset;
+		for (auto& histogram : _threadHistograms)
+		{
+			int count = histogram[cell];
+			histogram[cell] = offset;
+			offset += count;
+		}
+	}
+}
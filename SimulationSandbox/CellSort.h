@@ -0,0 +1,87 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+
+// Parallel counting sort of item indices by cell, shared by the grid broadphases.
+// Items of a cell end up in one contiguous run, so a build needs no locks and no
+// per-cell allocations. Each pass is split into slots that run in parallel, one pass after another:
+//   count -> sumCells -> assignOffsets -> scatter
+// 'count' and 'scatter' must see the same keys, so the items may not move in between.
+class CellSort
+{
+private:
+	std::vector<int> _cellStart;
+	std::vector<int> _cellCount;
+	std::vector<int> _sortedItems;
+
+	// One histogram per thread; after assignOffsets each entry holds that thread's write cursor
+	std::vector<std::vector<int>> _threadHistograms;
+	std::vector<int> _threadCellTotals;
+
+	void getCellRange(int threadIndex, int numThreads, int& startCell, int& endCell) const;
+
+public:
+	void init(size_t numCells, int numThreads);
+
+	// Pass 1: per-thread histogram over the item range [begin, end)
+	template <typename KeyFn>
+	void count(int begin, int end, int threadIndex, size_t numItems, KeyFn&& cellOf)
+	{
+		// Nobody reads the sorted items before the scatter pass, so thread 0 can size them here
+		if (threadIndex == 0)
+		{
+			_sortedItems.resize(numItems);
+		}
+
+		std::vector<int>& histogram = _threadHistograms[threadIndex];
+		std::fill(histogram.begin(), histogram.end(), 0);
+
+		for (int i = begin; i < end; ++i)
+		{
+			histogram[cellOf(i)]++;
+		}
+	}
+
+	// Pass 2a: cell counts and the total of this thread's cell range
+	void sumCells(int threadIndex, int numThreads);
+	// Pass 2b: exclusive prefix sum into cell starts and per-thread write cursors
+	void assignOffsets(int threadIndex, int numThreads);
+
+	// Pass 3: write item indices into their cell's run
+	template <typename KeyFn>
+	void scatter(int begin, int end, int threadIndex, KeyFn&& cellOf)
+	{
+		std::vector<int>& cursor = _threadHistograms[threadIndex];
+		for (int i = begin; i < end; ++i)
+		{
+			_sortedItems[cursor[cellOf(i)]++] = i;
+		}
+	}
+
+	// Single-threaded convenience, runs all passes as if every thread took its share
+	template <typename KeyFn>
+	void build(size_t numItems, KeyFn&& cellOf)
+	{
+		const int numThreads = static_cast<int>(_threadHistograms.size());
+		if (numThreads == 0) return; // not initialised
+
+		const int count32 = static_cast<int>(numItems);
+		const int itemsPerThread = (count32 + numThreads - 1) / numThreads;
+		for (int t = 0; t < numThreads; ++t)
+		{
+			count(std::min(t * itemsPerThread, count32), std::min((t + 1) * itemsPerThread, count32), t, numItems, cellOf);
+		}
+		for (int t = 0; t < numThreads; ++t) sumCells(t, numThreads);
+		for (int t = 0; t < numThreads; ++t) assignOffsets(t, numThreads);
+		for (int t = 0; t < numThreads; ++t)
+		{
+			scatter(std::min(t * itemsPerThread, count32), std::min((t + 1) * itemsPerThread, count32), t, cellOf);
+		}
+	}
+
+	int getCellStart(int cell) const { return _cellStart[cell]; }
+	int getCellCount(int cell) const { return _cellCount[cell]; }
+	const int* getCellItems(int cell) const { return _sortedItems.data() + _cellStart[cell]; }
+	size_t getNumCells() const { return _cellCount.size(); }
+	size_t getNumItems() const { return _sortedItems.size(); }
+};
@@ -1,4 +1,10 @@
 #include "Collider.h"
+#include "CollisionDispatch.h"
+
+bool Collider::isColliding(const Collider& other, DirectX::XMFLOAT3& outNormal, float& penetrationDepth) const
+{
+	return CollisionDispatch::test(*this, other, outNormal, penetrationDepth);
+}
 
 DirectX::XMMATRIX Collider::updateWorldMatrix() const
 {
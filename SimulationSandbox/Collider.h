@@ -1,5 +1,6 @@
 #pragma once
 #include <DirectXMath.h>
+#include <cstdint>
 #include "globals.h"
 
 class Sphere;
@@ -8,24 +9,42 @@ class Cylinder;
 class Cube;	
 class Capsule;
 
+// Concrete collider class, used to pick the narrowphase test without RTTI
+enum class ShapeType : uint8_t
+{
+	SPHERE,
+	PLANE,
+	CUBE,
+	CAPSULE,
+	CYLINDER,
+	COUNT
+};
+
 class Collider
 {
 private:
+	ShapeType _shapeType;
 	DirectX::XMFLOAT3 _position = { 0.0f, 0.0f, 0.0f };
 	DirectX::XMFLOAT3 _rotation = { 0.0f, 0.0f, 1.0f };
 	DirectX::XMFLOAT3 _scale = { 1.0f, 1.0f, 1.0f };
-public:
-	Collider(DirectX::XMFLOAT3 position = { 0.0f, globals::AXIS_LENGTH - 0.5f, 0.0f }, DirectX::XMFLOAT3 rotation = { 0.0f, 0.0f, 0.0f }, DirectX::XMFLOAT3 scale = { 1.0f, 1.0f, 1.0f }) :
-		_position(position), _rotation(rotation), _scale(scale)
+protected:
+	Collider(ShapeType shapeType, DirectX::XMFLOAT3 position = { 0.0f, globals::AXIS_LENGTH - 0.5f, 0.0f }, DirectX::XMFLOAT3 rotation = { 0.0f, 0.0f, 0.0f }, DirectX::XMFLOAT3 scale = { 1.0f, 1.0f, 1.0f }) :
+		_shapeType(shapeType), _position(position), _rotation(rotation), _scale(scale)
 	{
 		if (_scale.x < 0.0001f) _scale.x = 1.0f;
 		if (_scale.y < 0.0001f) _scale.y = 1.0f;
 		if (_scale.z < 0.0001f) _scale.z = 1.0f;
 	}
 
+public:
 	virtual ~Collider() = default;
 
-	virtual bool isColliding(const Collider& other, DirectX::XMFLOAT3& outNormal, float& penetrationDepth) const = 0;
+	ShapeType getShapeType() const { return _shapeType; }
+
+	// Looks the test up in the CollisionDispatch table; the normal points from 'other' towards this collider
+	bool isColliding(const Collider& other, DirectX::XMFLOAT3& outNormal, float& penetrationDepth) const;
+	// World-space bounding box, false for unbounded shapes such as planes
+	virtual bool getBounds(DirectX::XMFLOAT3& /*outMin*/, DirectX::XMFLOAT3& /*outMax*/) const { return false; }
 	DirectX::XMMATRIX updateWorldMatrix() const;
 
 	DirectX::XMFLOAT3& getPosition() { return _position; } // Non-const version
@@ -0,0 +1,64 @@
+#include "CollisionDispatch.h"
+#include "Sphere.h"
+#include "Plane.h"
+#include "Cube.h"
+#include "Capsule.h"
+#include "Cylinder.h"
+#include <array>
+#include <utility>
+
+namespace
+{
+	constexpr size_t NUM_SHAPES = static_cast<size_t>(ShapeType::COUNT);
+
+	// Sphere against a collider whose type is known at compile time
+	template <ShapeType Other>
+	bool testSphere(const Sphere& sphere, const Collider& other, DirectX::XMFLOAT3& outNormal, float& penetrationDepth)
+	{
+		if constexpr (Other == ShapeType::SPHERE) return sphere.isCollidingWithSphere(static_cast<const Sphere&>(other), outNormal, penetrationDepth);
+		else if constexpr (Other == ShapeType::PLANE) return sphere.isCollidingWithPlane(static_cast<const Plane&>(other), outNormal, penetrationDepth);
+		else if constexpr (Other == ShapeType::CUBE) return sphere.isCollidingWithCube(static_cast<const Cube&>(other), outNormal, penetrationDepth);
+		else if constexpr (Other == ShapeType::CAPSULE) return sphere.isCollidingWithCapsule(static_cast<const Capsule&>(other), outNormal, penetrationDepth);
+		else if constexpr (Other == ShapeType::CYLINDER) return sphere.isCollidingWithCylinder(static_cast<const Cylinder&>(other), outNormal, penetrationDepth);
+		else return false;
+	}
+
+	template <ShapeType A, ShapeType B>
+	bool testShapes(const Collider& a, const Collider& b, DirectX::XMFLOAT3& outNormal, float& penetrationDepth)
+	{
+		if constexpr (A == ShapeType::SPHERE)
+		{
+			return testSphere<B>(static_cast<const Sphere&>(a), b, outNormal, penetrationDepth);
+		}
+		else if constexpr (B == ShapeType::SPHERE)
+		{
+			// The sphere tests return a normal pointing towards the sphere, flip it to point towards 'a'
+			bool result = testSphere<A>(static_cast<const Sphere&>(b), a, outNormal, penetrationDepth);
+			if (result)
+			{
+				outNormal.x = -outNormal.x;
+				outNormal.y = -outNormal.y;
+				outNormal.z = -outNormal.z;
+			}
+			return result;
+		}
+		else
+		{
+			return false; // no test for two non-spheres
+		}
+	}
+
+	template <size_t... Index>
+	constexpr std::array<CollisionDispatch::TestFunction, sizeof...(Index)> makeTable(std::index_sequence<Index...>)
+	{
+		return { &testShapes<static_cast<ShapeType>(Index / NUM_SHAPES), static_cast<ShapeType>(Index % NUM_SHAPES)>... };
+	}
+
+	// Row is the type of 'a', column the type of 'b'
+	constexpr auto testTable = makeTable(std::make_index_sequence<NUM_SHAPES * NUM_SHAPES>{});
+}
+
+CollisionDispatch::TestFunction CollisionDispatch::getTest(ShapeType a, ShapeType b)
+{
+	return testTable[static_cast<size_t>(a) * NUM_SHAPES + static_cast<size_t>(b)];
+}
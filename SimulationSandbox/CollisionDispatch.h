@@ -0,0 +1,21 @@
+#pragma once
+#include <DirectXMath.h>
+#include "Collider.h"
+
+// Narrowphase lookup by shape type.
+// A [ShapeType][ShapeType] table of test functions is generated at compile time, so a pair
+// costs one indexed call instead of a chain of dynamic_casts. Only pairs involving a sphere
+// have a test; every other pair reports no collision, as before.
+class CollisionDispatch
+{
+public:
+	// The normal points from 'b' towards 'a'
+	using TestFunction = bool (*)(const Collider& a, const Collider& b, DirectX::XMFLOAT3& outNormal, float& penetrationDepth);
+
+	static TestFunction getTest(ShapeType a, ShapeType b);
+
+	static bool test(const Collider& a, const Collider& b, DirectX::XMFLOAT3& outNormal, float& penetrationDepth)
+	{
+		return getTest(a.getShapeType(), b.getShapeType())(a, b, outNormal, penetrationDepth);
+	}
+};
@@ -0,0 +1,69 @@
+#include "ContactCache.h"
+
+void ContactCache::clear()
+{
+	_slotKeys.clear();
+	_slotImpulses.clear();
+	_occupiedSlots.clear();
+	_slotMask = 0;
+	_slotShift = 64;
+}
+
+ContactImpulse ContactCache::find(uint64_t key) const
+{
+	if (key == NO_KEY || _occupiedSlots.empty()) return {};
+
+	for (int slot = getSlot(key); ; slot = (slot + 1) & _slotMask)
+	{
+		if (_slotKeys[slot] == key) return _slotImpulses[slot];
+		if (_slotKeys[slot] == NO_KEY) return {};
+	}
+}
+
+void ContactCache::beginStore(size_t numContacts)
+{
+	size_t capacity = MIN_CAPACITY;
+	while (capacity < numContacts * 2) capacity *= 2;
+
+	// Keep the table unless it is too small, or far too big after a busy tick
+	if (capacity <= _slotKeys.size() && capacity * 8 > _slotKeys.size())
+	{
+		for (int slot : _occupiedSlots)
+		{
+			_slotKeys[slot] = NO_KEY;
+		}
+		_occupiedSlots.clear();
+		return;
+	}
+
+	_slotKeys.assign(capacity, NO_KEY);
+	_slotImpulses.assign(capacity, {});
+	_occupiedSlots.clear();
+	_slotMask = static_cast<int>(capacity) - 1;
+
+	int bits = 0;
+	while ((size_t(1) << bits) < capacity) ++bits;
+	_slotShift = 64 - bits;
+}
+
+void ContactCache::store(uint64_t key, const ContactImpulse& impulse)
+{
+	if (key == NO_KEY) return;
+
+	for (int slot = getSlot(key); ; slot = (slot + 1) & _slotMask)
+	{
+		if (_slotKeys[slot] == NO_KEY)
+		{
+			// At most 'numContacts' keys go into twice as many slots, so a free slot always exists
+			_slotKeys[slot] = key;
+			_slotImpulses[slot] = impulse;
+			_occupiedSlots.push_back(slot);
+			return;
+		}
+		if (_slotKeys[slot] == key)
+		{
+			_slotImpulses[slot] = impulse; // the same pair found twice, keep the later one
+			return;
+		}
+	}
+}
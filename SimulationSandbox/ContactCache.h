@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Impulses a contact applied over one tick, on one of its two bodies
+struct ContactImpulse
+{
+	float normal = 0.0f;                               // along the contact normal, never negative
+	float tangentX = 0.0f, tangentY = 0.0f, tangentZ = 0.0f; // friction, in world space
+};
+
+// Impulses of last tick's contacts, keyed by object ids so they survive body reordering.
+// Each tick the solver starts every contact from what it needed last time (warm starting)
+// instead of from zero, which settles stacks in far fewer ticks.
+// Open-addressing table (linear probing) like SpatialHash. Lookups are read-only and may run on
+// all threads at once; the table is rebuilt by one thread between ticks.
+class ContactCache
+{
+public:
+	static constexpr uint64_t NO_KEY = ~0ull; // objects without an id are not cached
+
+private:
+	static constexpr int MIN_CAPACITY = 1024;
+
+	std::vector<uint64_t> _slotKeys;
+	std::vector<ContactImpulse> _slotImpulses;
+	std::vector<int> _occupiedSlots; // cleared before the next rebuild
+	int _slotMask = 0;
+	int _slotShift = 64;
+
+	int getSlot(uint64_t key) const
+	{
+		return static_cast<int>((key * 0x9E3779B97F4A7C15ull) >> _slotShift); // Fibonacci hashing
+	}
+
+public:
+	// Same key whichever object comes first; the impulse is stored for the lower id
+	static uint64_t makeKey(int objectIdA, int objectIdB)
+	{
+		if (objectIdA < 0 || objectIdB < 0) return NO_KEY;
+		if (objectIdA > objectIdB) std::swap(objectIdA, objectIdB);
+		return (static_cast<uint64_t>(objectIdA) << 32) | static_cast<uint32_t>(objectIdB);
+	}
+	// Fixed bodies are keyed by their index, kept apart from object ids by the top bit
+	static uint64_t makeFixedKey(int objectId, int fixedIndex)
+	{
+		if (objectId < 0) return NO_KEY;
+		return (static_cast<uint64_t>(objectId) << 32) | 0x80000000u | static_cast<uint32_t>(fixedIndex);
+	}
+
+	void clear();
+
+	// Last tick's impulse of the contact, zero when it is new
+	ContactImpulse find(uint64_t key) const;
+
+	// Drops the stored contacts and makes room for 'numContacts' new ones
+	void beginStore(size_t numContacts);
+	void store(uint64_t key, const ContactImpulse& impulse);
+
+	size_t size() const { return _occupiedSlots.size(); }
+};
@@ -0,0 +1,77 @@
+#include "ContactColouring.h"
+#include <bit>
+
+void ContactColouring::reserve(size_t numPairs)
+{
+	_pairColours.reserve(numPairs);
+	_pairs.reserve(numPairs);
+}
+
+void ContactColouring::clear()
+{
+	_bodyColours.clear();
+	_pairColours.clear();
+	_pairs.clear();
+	_numColours = 0;
+	_numParallelColours = 0;
+}
+
+void ContactColouring::build(std::span<const CollisionPair> pairs, int numBodies, size_t minParallelPairs)
+{
+	const size_t numPairs = pairs.size();
+
+	_bodyColours.assign(numBodies, 0);
+	_pairColours.resize(numPairs);
+	_pairs.resize(numPairs);
+
+	// Greedy colouring, in input order. A fixed body is never written, so only the
+	// moving body of a fixed pair takes up the colour.
+	size_t counts[MAX_COLOURS + 1] = {};
+	for (size_t k = 0; k < numPairs; ++k)
+	{
+		const CollisionPair& pair = pairs[k];
+		uint64_t used = _bodyColours[pair.bodyA];
+		if (!pair.bIsFixed) used |= _bodyColours[pair.bodyB];
+
+		int colour = MAX_COLOURS; // overflow
+		if (used != ~0ull)
+		{
+			colour = std::countr_zero(~used);
+			const uint64_t bit = 1ull << colour;
+			_bodyColours[pair.bodyA] |= bit;
+			if (!pair.bIsFixed) _bodyColours[pair.bodyB] |= bit;
+		}
+
+		_pairColours[k] = static_cast<uint8_t>(colour);
+		++counts[colour];
+	}
+
+	// Lowest colour first means every colour below the highest one is in use
+	_numColours = 0;
+	for (int c = 0; c <= MAX_COLOURS; ++c)
+	{
+		if (counts[c] > 0) _numColours = c + 1;
+	}
+
+	_colourStart[0] = 0;
+	for (int c = 0; c < _numColours; ++c)
+	{
+		_colourStart[c + 1] = _colourStart[c] + counts[c];
+	}
+
+	// Group the pairs by colour, keeping their order within a colour
+	size_t offsets[MAX_COLOURS + 1];
+	for (int c = 0; c < _numColours; ++c) offsets[c] = _colourStart[c];
+	for (size_t k = 0; k < numPairs; ++k)
+	{
+		_pairs[offsets[_pairColours[k]]++] = pairs[k];
+	}
+
+	// Trailing small colours (and the overflow one) are cheaper on one thread than behind a barrier each
+	_numParallelColours = _numColours;
+	while (_numParallelColours > 0 &&
+		(_numParallelColours - 1 == MAX_COLOURS || counts[_numParallelColours - 1] < minParallelPairs))
+	{
+		--_numParallelColours;
+	}
+}
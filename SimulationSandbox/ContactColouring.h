@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <cstddef>
+#include <cstdint>
+#include <DirectXMath.h>
+
+// A touching pair as found by detection, with the contact it found, so resolving never has to test it again
+struct CollisionPair
+{
+	int bodyA; // index into the body store
+	int bodyB; // index into the body store, or into the fixed bodies when bIsFixed is set
+	bool bIsFixed;
+	DirectX::XMFLOAT3 normal; // towards bodyA
+	float depth;
+	DirectX::XMFLOAT3 point;  // halfway through the overlap
+};
+
+// Splits the contacts of a tick into colours in which no moving body appears twice, so the
+// contacts of one colour can be resolved in parallel without two threads writing the same body.
+// Greedy: each contact takes the lowest colour neither of its bodies has used yet. Colours are
+// tracked as one bit per colour per body; contacts that find all of them taken go into a last,
+// overflow colour that may repeat bodies and is always resolved serially.
+class ContactColouring
+{
+public:
+	static constexpr int MAX_COLOURS = 64; // bits in a body's colour mask
+
+private:
+	std::vector<uint64_t> _bodyColours;   // colours used by each body so far
+	std::vector<uint8_t> _pairColours;    // colour of each input pair
+	std::vector<CollisionPair> _pairs;    // all pairs, grouped by colour
+	size_t _colourStart[MAX_COLOURS + 2] = {};
+	int _numColours = 0;
+	int _numParallelColours = 0;
+
+public:
+	void reserve(size_t numPairs);
+	void clear();
+
+	// Colours the pairs. Colours with fewer than 'minParallelPairs' pairs that come after the
+	// last larger one are not worth a barrier each and are left to getSerialStart().
+	void build(std::span<const CollisionPair> pairs, int numBodies, size_t minParallelPairs);
+
+	const std::vector<CollisionPair>& getPairs() const { return _pairs; }
+	int getNumColours() const { return _numColours; }
+
+	// The first colours, resolved one after another with the pairs of each split over the threads
+	int getNumParallelColours() const { return _numParallelColours; }
+	size_t getColourStart(int colour) const { return _colourStart[colour]; }
+	size_t getColourEnd(int colour) const { return _colourStart[colour + 1]; }
+
+	// Pairs from here to the end are resolved by a single thread, in order
+	size_t getSerialStart() const { return _colourStart[_numParallelColours]; }
+};
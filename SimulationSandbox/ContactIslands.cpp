@@ -0,0 +1,170 @@
+#include "ContactIslands.h"
+#include <atomic>
+#include <utility>
+
+void ContactIslands::resize(size_t numBodies)
+{
+	_parent.resize(numBodies);
+}
+
+void ContactIslands::clear()
+{
+	_parent.clear();
+	_islands.clear();
+	_bodies.clear();
+	_pairs.clear();
+	_taskStart.clear();
+	_numLargeIslands = 0;
+}
+
+int ContactIslands::find(int body)
+{
+	// Path halving: every link skipped on the way now points at its grandparent. Only a root's
+	// link is ever changed by a union, so an ancestor written here is always still valid.
+	while (true)
+	{
+		std::atomic_ref<int> link(_parent[body]);
+		int parent = link.load(std::memory_order_acquire);
+		if (parent == body) return body;
+
+		int grandparent = std::atomic_ref<int>(_parent[parent]).load(std::memory_order_acquire);
+		if (grandparent != parent)
+		{
+			link.compare_exchange_weak(parent, grandparent, std::memory_order_acq_rel);
+		}
+		body = grandparent;
+	}
+}
+
+void ContactIslands::resetBodies(int begin, int end)
+{
+	for (int i = begin; i < end; ++i)
+	{
+		_parent[i] = i;
+	}
+}
+
+void ContactIslands::unitePairs(std::span<const CollisionPair> pairs)
+{
+	for (const CollisionPair& pair : pairs)
+	{
+		// Fixed bodies are never written while resolving, so they do not connect anything
+		if (pair.bIsFixed) continue;
+
+		int a = pair.bodyA;
+		int b = pair.bodyB;
+		while (true)
+		{
+			a = find(a);
+			b = find(b);
+			if (a == b) break;
+
+			// The higher root goes under the lower one; if another thread linked it first, look again
+			if (a < b) std::swap(a, b);
+			int expected = a;
+			if (std::atomic_ref<int>(_parent[a]).compare_exchange_strong(expected, b, std::memory_order_acq_rel)) break;
+		}
+	}
+}
+
+void ContactIslands::findRoots(int begin, int end)
+{
+	for (int i = begin; i < end; ++i)
+	{
+		std::atomic_ref<int>(_parent[i]).store(find(i), std::memory_order_release);
+	}
+}
+
+void ContactIslands::build(const std::vector<std::vector<CollisionPair>>& pairLists, int numBodies, size_t minLargePairs, int taskCost)
+{
+	// Bodies and pairs per root
+	_bodyCursor.assign(numBodies, 0);
+	_pairCursor.assign(numBodies, 0);
+	_islandOfRoot.resize(numBodies);
+
+	size_t numPairs = 0;
+	for (int i = 0; i < numBodies; ++i) ++_bodyCursor[_parent[i]];
+	for (const auto& pairs : pairLists)
+	{
+		for (const CollisionPair& pair : pairs) ++_pairCursor[_parent[pair.bodyA]];
+		numPairs += pairs.size();
+	}
+
+	// One island per root, large ones first, each group in root order
+	_islands.clear();
+	for (bool large : { true, false })
+	{
+		if (!large) _numLargeIslands = static_cast<int>(_islands.size());
+
+		for (int root = 0; root < numBodies; ++root)
+		{
+			if (_parent[root] != root || (_pairCursor[root] >= minLargePairs) != large) continue;
+
+			_islandOfRoot[root] = static_cast<int>(_islands.size());
+			_islands.push_back({ 0, _bodyCursor[root], 0, _pairCursor[root] });
+		}
+	}
+
+	// Offsets, then the write cursor of every root starts at its island's offset
+	int firstBody = 0;
+	size_t firstPair = 0;
+	for (Island& island : _islands)
+	{
+		island.firstBody = firstBody;
+		island.firstPair = firstPair;
+		firstBody += island.numBodies;
+		firstPair += island.numPairs;
+	}
+	for (int root = 0; root < numBodies; ++root)
+	{
+		if (_parent[root] != root) continue;
+		const Island& island = _islands[_islandOfRoot[root]];
+		_bodyCursor[root] = island.firstBody;
+		_pairCursor[root] = island.firstPair;
+	}
+
+	// Scatter, keeping body order and the order of the pairs in the lists
+	_bodies.resize(numBodies);
+	_pairs.resize(numPairs);
+	for (int i = 0; i < numBodies; ++i)
+	{
+		_bodies[_bodyCursor[_parent[i]]++] = i;
+	}
+	for (const auto& pairs : pairLists)
+	{
+		for (const CollisionPair& pair : pairs)
+		{
+			_pairs[_pairCursor[_parent[pair.bodyA]]++] = pair;
+		}
+	}
+
+	// Pack the small islands into tasks, most are single bodies without contacts
+	const int numIslands = static_cast<int>(_islands.size());
+	_taskStart.clear();
+	_taskStart.push_back(_numLargeIslands);
+	int cost = 0;
+	for (int i = _numLargeIslands; i < numIslands; ++i)
+	{
+		cost += _islands[i].numBodies + static_cast<int>(_islands[i].numPairs);
+		if (cost >= taskCost)
+		{
+			_taskStart.push_back(i + 1);
+			cost = 0;
+		}
+	}
+	if (_taskStart.back() != numIslands) _taskStart.push_back(numIslands);
+}
+
+int ContactIslands::getLargeBodyCount() const
+{
+	if (_numLargeIslands == 0) return 0;
+	const Island& last = _islands[_numLargeIslands - 1];
+	return last.firstBody + last.numBodies;
+}
+
+std::span<const CollisionPair> ContactIslands::getLargePairs() const
+{
+	if (_numLargeIslands == 0) return {};
+	const Island& last = _islands[_numLargeIslands - 1];
+	return { _pairs.data(), last.firstPair + last.numPairs };
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <cstddef>
+#include "ContactColouring.h"
+
+// Groups the moving bodies of a tick into islands: bodies connected through moving-vs-moving
+// contacts. Bodies of different islands never touch each other's state while resolving, so
+// each island can be handled on its own.
+// Connected components come from a lock-free union-find, in passes split over the workers, each finished before the next:
+//   resetBodies -> unitePairs -> findRoots -> build (one thread)
+// Every island is rooted at its lowest body index, so the result does not depend on the thread count.
+class ContactIslands
+{
+public:
+	struct Island
+	{
+		int firstBody;    // into getBodies()
+		int numBodies;
+		size_t firstPair; // into getPairs()
+		size_t numPairs;
+	};
+
+private:
+	std::vector<int> _parent; // union-find forest over body indices, then the root of every body
+	std::vector<int> _islandOfRoot;
+	std::vector<int> _bodyCursor;
+	std::vector<size_t> _pairCursor;
+
+	std::vector<Island> _islands;
+	std::vector<int> _bodies;           // body indices, grouped by island
+	std::vector<CollisionPair> _pairs;  // pairs, grouped by island
+	std::vector<int> _taskStart;        // first island of every task, plus the end
+
+	int _numLargeIslands = 0;
+
+	int find(int body);
+
+public:
+	// Called between ticks, whenever the body count may have changed
+	void resize(size_t numBodies);
+	void clear();
+
+	// Pass 1: every body of [begin, end) starts as its own island
+	void resetBodies(int begin, int end);
+	// Pass 2: joins the islands of both bodies of every moving pair, safe to run from all threads at once
+	void unitePairs(std::span<const CollisionPair> pairs);
+	// Pass 3: stores the final root of every body of [begin, end)
+	void findRoots(int begin, int end);
+
+	// Pass 4, one thread: lays the bodies and pairs of all lists out island by island. Islands with
+	// at least 'minLargePairs' pairs go first and are left to the caller; the rest are packed into
+	// tasks of roughly 'taskCost' bodies and pairs.
+	void build(const std::vector<std::vector<CollisionPair>>& pairLists, int numBodies, size_t minLargePairs, int taskCost);
+
+	const std::vector<Island>& getIslands() const { return _islands; }
+	const std::vector<int>& getBodies() const { return _bodies; }
+	const std::vector<CollisionPair>& getPairs() const { return _pairs; }
+
+	// The large islands are islands [0, getNumLargeIslands()), their bodies and pairs the start of both arrays
+	int getNumLargeIslands() const { return _numLargeIslands; }
+	int getLargeBodyCount() const;
+	std::span<const CollisionPair> getLargePairs() const;
+
+	// Tasks cover the remaining islands in order
+	int getNumTasks() const { return static_cast<int>(_taskStart.size()) - 1; }
+	int getTaskStart(int task) const { return _taskStart[task]; }
+	int getTaskEnd(int task) const { return _taskStart[task + 1]; }
+};
@@ -0,0 +1,286 @@
+#include "CpuTopology.h"
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <tuple>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#endif
+
+std::atomic<PinningPolicy> CpuTopology::_policy{ PinningPolicy::PHYSICAL_CORES };
+
+const CpuTopology& CpuTopology::get()
+{
+	static const CpuTopology topology;
+	return topology;
+}
+
+CpuTopology::CpuTopology()
+{
+	if (!probe() || _processors.empty()) probeFallback();
+	sortProcessors();
+}
+
+void CpuTopology::probeFallback()
+{
+	_processors.clear();
+	const int numLogical = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	for (int i = 0; i < numLogical; ++i)
+	{
+		_processors.push_back({ 0, i, i, 0 });
+	}
+}
+
+#if defined(_WIN32)
+
+bool CpuTopology::probe()
+{
+	DWORD length = 0;
+	GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+	if (GetLastError() != ERROR_INSUFFICIENT_BUFFER) return false;
+
+	std::vector<char> buffer(length);
+	auto* first = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data());
+	if (!GetLogicalProcessorInformationEx(RelationAll, first, &length)) return false;
+
+	// Cores first, every set bit of a core's mask is one of its logical processors
+	int numCores = 0;
+	for (DWORD offset = 0; offset < length;)
+	{
+		auto* info = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+		if (info->Relationship == RelationProcessorCore)
+		{
+			for (WORD g = 0; g < info->Processor.GroupCount; ++g)
+			{
+				const GROUP_AFFINITY& affinity = info->Processor.GroupMask[g];
+				for (int bit = 0; bit < static_cast<int>(sizeof(KAFFINITY) * 8); ++bit)
+				{
+					if (affinity.Mask & (static_cast<KAFFINITY>(1) << bit)) _processors.push_back({ affinity.Group, bit, numCores, 0 });
+				}
+			}
+			++numCores;
+		}
+		offset += info->Size;
+	}
+
+	// Then the node of every processor
+	for (DWORD offset = 0; offset < length;)
+	{
+		auto* info = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+		if (info->Relationship == RelationNumaNode)
+		{
+			const GROUP_AFFINITY& affinity = info->NumaNode.GroupMask;
+			for (Processor& processor : _processors)
+			{
+				if (processor.group == affinity.Group && (affinity.Mask & (static_cast<KAFFINITY>(1) << processor.number)))
+				{
+					processor.node = static_cast<int>(info->NumaNode.NodeNumber);
+				}
+			}
+		}
+		offset += info->Size;
+	}
+	return true;
+}
+
+bool CpuTopology::setAffinity(const std::vector<int>& processors) const
+{
+	// A thread runs in a single group, that of the first processor
+	GROUP_AFFINITY affinity = {};
+	affinity.Group = static_cast<WORD>(_processors[processors.front()].group);
+	for (int i : processors)
+	{
+		const Processor& processor = _processors[i];
+		if (processor.group == affinity.Group) affinity.Mask |= static_cast<KAFFINITY>(1) << processor.number;
+	}
+	return SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != 0;
+}
+
+bool CpuTopology::resetAffinity() const
+{
+	DWORD_PTR processMask = 0, systemMask = 0;
+	if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) return false;
+	if (processMask == 0) return true; // the process spans several groups, which has no single mask
+	return SetThreadAffinityMask(GetCurrentThread(), processMask) != 0;
+}
+
+#elif defined(__linux__)
+
+namespace
+{
+	int readInt(const std::filesystem::path& path, int fallback)
+	{
+		std::ifstream file(path);
+		int value = fallback;
+		if (!(file >> value)) return fallback;
+		return value;
+	}
+}
+
+bool CpuTopology::probe()
+{
+	// Only the CPUs this process may run on
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return false;
+
+	const std::filesystem::path cpuRoot = "/sys/devices/system/cpu";
+	std::map<std::pair<int, int>, int> coreOfPackage; // (package, core id) -> core
+	for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+	{
+		if (!CPU_ISSET(cpu, &allowed)) continue;
+
+		const std::filesystem::path cpuPath = cpuRoot / ("cpu" + std::to_string(cpu));
+		const int package = readInt(cpuPath / "topology" / "physical_package_id", 0);
+		const int coreId = readInt(cpuPath / "topology" / "core_id", cpu);
+		const auto core = coreOfPackage.emplace(std::make_pair(package, coreId), static_cast<int>(coreOfPackage.size())).first->second;
+
+		// The node shows up as a 'nodeN' link in the CPU's directory
+		int node = 0;
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator(cpuPath, error))
+		{
+			const std::string name = entry.path().filename().string();
+			if (name.size() > 4 && name.compare(0, 4, "node") == 0 && name.find_first_not_of("0123456789", 4) == std::string::npos)
+			{
+				node = std::stoi(name.substr(4));
+				break;
+			}
+		}
+
+		_processors.push_back({ 0, cpu, core, node });
+	}
+	return true;
+}
+
+bool CpuTopology::setAffinity(const std::vector<int>& processors) const
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (int i : processors) CPU_SET(_processors[i].number, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+bool CpuTopology::resetAffinity() const
+{
+	// probe() only kept the CPUs the process may run on
+	std::vector<int> processors(_processors.size());
+	std::iota(processors.begin(), processors.end(), 0);
+	return setAffinity(processors);
+}
+
+#else
+
+bool CpuTopology::probe()
+{
+	return false;
+}
+
+bool CpuTopology::setAffinity(const std::vector<int>&) const
+{
+	return false;
+}
+
+bool CpuTopology::resetAffinity() const
+{
+	return true; // nothing is ever pinned here
+}
+
+#endif
+
+void CpuTopology::sortProcessors()
+{
+	// Node, then core, then the processor number, so the first processor of a core is its first sibling
+	std::sort(_processors.begin(), _processors.end(), [](const Processor& a, const Processor& b)
+		{
+			return std::tie(a.node, a.core, a.group, a.number) < std::tie(b.node, b.core, b.group, b.number);
+		});
+
+	// Cores renumbered in that order
+	_coreProcessors.clear();
+	_numNodes = 1;
+	int previousCore = -1, previousNode = -1;
+	for (int i = 0; i < static_cast<int>(_processors.size()); ++i)
+	{
+		Processor& processor = _processors[i];
+		if (processor.core != previousCore || processor.node != previousNode)
+		{
+			_coreProcessors.emplace_back();
+			previousCore = processor.core;
+			previousNode = processor.node;
+		}
+		processor.core = static_cast<int>(_coreProcessors.size()) - 1;
+		_coreProcessors.back().push_back(i);
+		_numNodes = std::max(_numNodes, processor.node + 1);
+	}
+}
+
+int CpuTopology::getDefaultWorkerCount() const
+{
+	return std::max(1, getNumPhysicalCores() - RESERVED_CORES);
+}
+
+int CpuTopology::findProcessor(ThreadRole role, int index) const
+{
+	const PinningPolicy policy = getPolicy();
+	const int numCores = getNumPhysicalCores();
+	if (policy == PinningPolicy::NONE || numCores == 0 || index < 0) return -1;
+
+	// Render and network share what there is on small machines
+	if (role == ThreadRole::RENDER) return _coreProcessors[0].front();
+	if (role == ThreadRole::NETWORK) return _coreProcessors[1 % numCores].front();
+
+	// Workers take the cores after the reserved ones, or all of them if that leaves none
+	const int firstCore = numCores > RESERVED_CORES ? RESERVED_CORES : 0;
+	const int numFreeCores = numCores - firstCore;
+	if (policy == PinningPolicy::PHYSICAL_CORES)
+	{
+		return index < numFreeCores ? _coreProcessors[firstCore + index].front() : -1;
+	}
+
+	// LOGICAL: the first sibling of every free core, then the second, and so on
+	for (int sibling = 0, remaining = index; ; ++sibling)
+	{
+		bool anyCore = false;
+		for (int core = firstCore; core < numCores; ++core)
+		{
+			const std::vector<int>& siblings = _coreProcessors[core];
+			if (sibling >= static_cast<int>(siblings.size())) continue;
+			anyCore = true;
+			if (remaining-- == 0) return siblings[sibling];
+		}
+		if (!anyCore) return -1;
+	}
+}
+
+std::vector<int> CpuTopology::getFreeProcessors() const
+{
+	const int numCores = getNumPhysicalCores();
+	const int firstCore = numCores > RESERVED_CORES ? RESERVED_CORES : 0;
+	std::vector<int> processors;
+	for (int core = firstCore; core < numCores; ++core)
+	{
+		processors.insert(processors.end(), _coreProcessors[core].begin(), _coreProcessors[core].end());
+	}
+	return processors;
+}
+
+bool CpuTopology::pinCurrentThread(ThreadRole role, int index) const
+{
+	if (getPolicy() == PinningPolicy::NONE || getNumPhysicalCores() == 0) return resetAffinity();
+
+	const int processor = findProcessor(role, index);
+	if (processor >= 0) return setAffinity({ processor });
+
+	// More workers than the policy has processors for: they share the free cores, never the reserved ones
+	return setAffinity(getFreeProcessors());
+}
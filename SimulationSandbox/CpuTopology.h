@@ -0,0 +1,79 @@
+#pragma once
+#include <vector>
+#include <atomic>
+
+// Which logical processors the program's threads are pinned to
+enum class PinningPolicy
+{
+	NONE,           // no affinity, the OS places every thread
+	PHYSICAL_CORES, // a physical core per thread, SMT siblings left idle; threads beyond the cores share the free cores
+	LOGICAL         // every logical processor, the SMT siblings once every free core has a thread
+};
+
+enum class ThreadRole
+{
+	RENDER,    // the main thread, which also runs the GUI
+	NETWORK,
+	SIMULATION // the workers of the simulation, by worker index
+};
+
+// The logical processors of the machine grouped into physical cores and NUMA nodes, probed once.
+// The render and network threads get a physical core each, the first two, and the simulation
+// workers the cores after them. Cores are numbered node by node, so workers next to each other
+// share a node and the simulation stays on one node as long as it fits.
+// Windows reads GetLogicalProcessorInformationEx and pins with SetThreadGroupAffinity; Linux reads
+// /sys/devices/system/cpu and pins with pthread_setaffinity_np. Anywhere else every logical processor
+// counts as a core of its own and threads are not pinned.
+class CpuTopology
+{
+public:
+	static constexpr int RESERVED_CORES = 2; // render and network
+
+	struct Processor
+	{
+		int group;  // Windows processor group, 0 elsewhere
+		int number; // in the group: the bit of the affinity mask, or the Linux CPU number
+		int core;   // physical core, numbered across the machine
+		int node;   // NUMA node
+	};
+
+private:
+	std::vector<Processor> _processors;            // by node, core, then SMT sibling
+	std::vector<std::vector<int>> _coreProcessors; // logical processors of every physical core
+	int _numNodes = 1;
+
+	static std::atomic<PinningPolicy> _policy;
+
+	CpuTopology();
+	bool probe();
+	void probeFallback();
+	void sortProcessors();
+
+	// Index into _processors for the index-th thread of a role, or -1 when it gets no processor of its own
+	int findProcessor(ThreadRole role, int index) const;
+	// Every logical processor of the cores left to the workers
+	std::vector<int> getFreeProcessors() const;
+	// Threads start with the affinity of the thread that created them, so every thread is set explicitly
+	bool setAffinity(const std::vector<int>& processors) const;
+	bool resetAffinity() const; // back to whatever the process may use
+
+public:
+	static const CpuTopology& get();
+
+	int getNumLogical() const { return static_cast<int>(_processors.size()); }
+	int getNumPhysicalCores() const { return static_cast<int>(_coreProcessors.size()); }
+	int getNumNodes() const { return _numNodes; }
+	const std::vector<Processor>& getProcessors() const { return _processors; }
+
+	// One simulation worker per physical core that is not reserved
+	int getDefaultWorkerCount() const;
+
+	// Takes effect for threads pinned afterwards
+	static void setPolicy(PinningPolicy policy) { _policy.store(policy); }
+	static PinningPolicy getPolicy() { return _policy.load(); }
+
+	// Pins the calling thread as the index-th thread of its role. Under NONE it may run anywhere again,
+	// and workers beyond the processors the policy hands out run on any of the free cores.
+	// False only if the OS refused.
+	bool pinCurrentThread(ThreadRole role, int index) const;
+};
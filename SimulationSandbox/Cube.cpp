@@ -1,15 +1,11 @@
 #include "Cube.h"
-#include "Sphere.h"
 
-bool Cube::isColliding(const Collider& other, DirectX::XMFLOAT3& outNormal, float& penetrationDepth) const
+bool Cube::getBounds(DirectX::XMFLOAT3& outMin, DirectX::XMFLOAT3& outMax) const
 {
-    if (const Sphere* sphere = dynamic_cast<const Sphere*>(&other)) {
-        bool result = sphere->isCollidingWithCube(*this, outNormal, penetrationDepth);
-        
-        outNormal.x = -outNormal.x;
-        outNormal.y = -outNormal.y;
-        outNormal.z = -outNormal.z;
-        return result;
-    }
-    return false;
+    // Same axis-aligned box as Sphere::isCollidingWithCube
+    const DirectX::XMFLOAT3& center = getPosition();
+    const DirectX::XMFLOAT3& scale = getScale();
+    outMin = { center.x - scale.x * 0.5f, center.y - scale.y * 0.5f, center.z - scale.z * 0.5f };
+    outMax = { center.x + scale.x * 0.5f, center.y + scale.y * 0.5f, center.z + scale.z * 0.5f };
+    return true;
 }
@@ -1,6 +1,6 @@
 #include "Cylinder.h"
-#include "Sphere.h"
 #include <algorithm>
+#include <cmath>
 
 using namespace DirectX;
 
@@ -28,16 +28,17 @@ void Cylinder::updateDimensionTransformation()
 		_radius *= 0.5f;*/		
 }
 
-bool Cylinder::isColliding(const Collider& other, XMFLOAT3& outNormal, float& penetrationDepth) const
+bool Cylinder::getBounds(DirectX::XMFLOAT3& outMin, DirectX::XMFLOAT3& outMax) const
 {
-    if (const Sphere* sphere = dynamic_cast<const Sphere*>(&other)) {
-        bool result = sphere->isCollidingWithCylinder(*this, outNormal, penetrationDepth);
-        // Invert normal to match this cylinder as 'self'
-        outNormal.x = -outNormal.x;
-        outNormal.y = -outNormal.y;
-        outNormal.z = -outNormal.z;
-        return result;
-    }
-    return false;
+    // Box around the central segment, grown by the radius
+    XMFLOAT3 axis = getAxis();
+    const XMFLOAT3& center = getPosition();
+    float halfHeight = getHeight() * 0.5f;
+    float extentX = fabsf(axis.x) * halfHeight + getRadius();
+    float extentY = fabsf(axis.y) * halfHeight + getRadius();
+    float extentZ = fabsf(axis.z) * halfHeight + getRadius();
+
+    outMin = { center.x - extentX, center.y - extentY, center.z - extentZ };
+    outMax = { center.x + extentX, center.y + extentY, center.z + extentZ };
+    return true;
 }
-
@@ -5,6 +5,7 @@
 #include <imgui_impl_dx11.h>
 #include <imgui_impl_win32.h>
 #include <chrono>
+#include "CpuTopology.h"
 
 #include "Scenario1.h"
 #include "Scenario2.h"
@@ -199,8 +200,8 @@ HRESULT D3DFramework::initDevice()
 	if (FAILED(hr))
 		return hr;
 
-	// Set affinity of main thread to Core 1 (rendering)
-	SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << 1);
+	// The main thread renders, on the first physical core unless the pinning policy says otherwise
+	CpuTopology::get().pinCurrentThread(ThreadRole::RENDER, 0);
 
 	// Obtain DXGI factory
 	CComPtr<IDXGIFactory1> dxgiFactory;
@@ -397,7 +398,6 @@ void D3DFramework::renderImGui() {
 		}
 
 		//static int selectedTimeCoefIndex = 2;
-		//static int selectedTimestepIndex = 1;
 
 		//ImGui::Begin("Scene Controls");
 		//ImGui::PushItemWidth(100);
@@ -407,15 +407,6 @@ void D3DFramework::renderImGui() {
 		//	selectedTimeCoefIndex = (selectedTimeCoefIndex < 0) ? 0 : (selectedTimeCoefIndex > 3) ? 3 : selectedTimeCoefIndex;
 		//	deltaTimeFactor = deltaTimeFactors[selectedTimeCoefIndex];
 		//}
-		//if (ImGui::SliderInt("Fixed timestep:", &selectedTimestepIndex, 0, 3, ""))
-		//{
-		//	// Ensure the index stays within the range of the array
-		//	selectedTimestepIndex = (selectedTimestepIndex < 0) ? 0 : (selectedTimestepIndex > 3) ? 3 : selectedTimestepIndex;
-		//	fixedTimestep = fixedTimesteps[selectedTimestepIndex] * deltaTimeFactor;
-		//	numMaxStep = maxSteps[selectedTimestepIndex];
-		//}
-		//ImGui::SameLine();
-		//ImGui::Text("%.3f", fixedTimestep);
 		//ImGui::PopItemWidth();
 		//ImGui::End();
 
@@ -564,9 +555,8 @@ void D3DFramework::setScenario(std::unique_ptr<Scenario> scenario, int scenarioI
 	// Load new scenario content (populate objects etc.)
 	_scenario->onLoad();
 
-	unsigned int totalCores = std::thread::hardware_concurrency();
-	//unsigned int simThreadCount = (totalCores > 3) ? totalCores - 3 : 4; // Default to 4 if unsure
-	unsigned int simThreadCount = 1;
+	// A worker per physical core after the render and network cores by default, or as set in the Broadphase menu
+	const int simThreadCount = physicsManager.getThreadCount();
 
 	physicsManager.startThreads(simThreadCount, 1.0f / globals::targetSimFrequencyHz.load());
 
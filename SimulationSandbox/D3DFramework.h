@@ -124,11 +124,6 @@ class D3DFramework final {
 	const float deltaTimeFactors[4] = {0.0f, 0.5f, 1.0f, 2.0f};
 	float deltaTimeFactor = deltaTimeFactors[2];
 	static float time;
-	const float fixedTimesteps[4] = { 0.002f, 0.004f, 0.008f, 0.016f };
-	float fixedTimestep = fixedTimesteps[1];
-	const int maxSteps[4] = { 8, 4, 2, 1 };
-	int numMaxStep = maxSteps[1];
-	float cumulativeTime = 0.0f;
 
 	Camera _camera;
 
@@ -0,0 +1,120 @@
+#include "HierarchicalGrid.h"
+#include <algorithm>
+#include <cmath>
+
+void HierarchicalGrid::init(float finestCellSize, const DirectX::XMFLOAT3& worldMin, const DirectX::XMFLOAT3& worldMax, int numThreads)
+{
+	_worldMin = worldMin;
+	_worldMax = worldMax;
+	_levels.clear();
+
+	DirectX::XMFLOAT3 worldSize = { worldMax.x - worldMin.x, worldMax.y - worldMin.y, worldMax.z - worldMin.z };
+	const float largestExtent = std::max({ worldSize.x, worldSize.y, worldSize.z });
+
+	// Levels double in cell size until a single cell spans the world
+	int firstCell = 0;
+	float cellSize = finestCellSize;
+	while (static_cast<int>(_levels.size()) < MAX_LEVELS)
+	{
+		Level level;
+		level.cellSize = cellSize;
+		level.inverseCellSize = 1.0f / cellSize;
+		level.cellsX = std::max(1, static_cast<int>(ceil(worldSize.x / cellSize)));
+		level.cellsY = std::max(1, static_cast<int>(ceil(worldSize.y / cellSize)));
+		level.cellsZ = std::max(1, static_cast<int>(ceil(worldSize.z / cellSize)));
+		level.firstCell = firstCell;
+		_levels.push_back(level);
+
+		firstCell += level.cellsX * level.cellsY * level.cellsZ;
+		if (cellSize >= largestExtent) break;
+		cellSize *= 2.0f;
+	}
+
+	numThreads = std::max(1, numThreads);
+	_sort.init(firstCell, numThreads);
+	_threadLevelCounts.assign(numThreads, std::vector<int>(_levels.size(), 0));
+	_levelCounts.assign(_levels.size(), 0);
+}
+
+int HierarchicalGrid::getLevel(float radius) const
+{
+	// Finest level whose cells hold the whole body; anything larger stays on the top level
+	const float diameter = 2.0f * radius;
+	const int topLevel = static_cast<int>(_levels.size()) - 1;
+	int level = 0;
+	while (level < topLevel && _levels[level].cellSize < diameter)
+	{
+		++level;
+	}
+	return level;
+}
+
+void HierarchicalGrid::getCellCoords(const Level& level, float x, float y, float z, int& cellX, int& cellY, int& cellZ) const
+{
+	// Bodies that slipped out of the world are kept in the border cells
+	x = std::clamp(x, _worldMin.x, _worldMax.x - 0.001f);
+	y = std::clamp(y, _worldMin.y, _worldMax.y - 0.001f);
+	z = std::clamp(z, _worldMin.z, _worldMax.z - 0.001f);
+	cellX = std::min(static_cast<int>((x - _worldMin.x) * level.inverseCellSize), level.cellsX - 1);
+	cellY = std::min(static_cast<int>((y - _worldMin.y) * level.inverseCellSize), level.cellsY - 1);
+	cellZ = std::min(static_cast<int>((z - _worldMin.z) * level.inverseCellSize), level.cellsZ - 1);
+}
+
+int HierarchicalGrid::getCellIndex(const BodyStore& bodies, int i) const
+{
+	const Level& level = _levels[getLevel(bodies.radius[i])];
+	int cellX, cellY, cellZ;
+	getCellCoords(level, bodies.posX[i], bodies.posY[i], bodies.posZ[i], cellX, cellY, cellZ);
+	return getCellIndex(level, cellX, cellY, cellZ);
+}
+
+void HierarchicalGrid::countBodies(const BodyStore& bodies, int begin, int end, int threadIndex)
+{
+	std::vector<int>& levelCounts = _threadLevelCounts[threadIndex];
+	std::fill(levelCounts.begin(), levelCounts.end(), 0);
+	for (int i = begin; i < end; ++i)
+	{
+		levelCounts[getLevel(bodies.radius[i])]++;
+	}
+
+	_sort.count(begin, end, threadIndex, bodies.size(), [&](int i) { return getCellIndex(bodies, i); });
+}
+
+void HierarchicalGrid::sumCells(int threadIndex, int numThreads)
+{
+	_sort.sumCells(threadIndex, numThreads);
+
+	// Nobody reads the level totals before the scatter pass
+	if (threadIndex == 0)
+	{
+		std::fill(_levelCounts.begin(), _levelCounts.end(), 0);
+		for (const auto& levelCounts : _threadLevelCounts)
+		{
+			for (size_t level = 0; level < levelCounts.size(); ++level)
+			{
+				_levelCounts[level] += levelCounts[level];
+			}
+		}
+	}
+}
+
+void HierarchicalGrid::scatterBodies(const BodyStore& bodies, int begin, int end, int threadIndex)
+{
+	_sort.scatter(begin, end, threadIndex, [&](int i) { return getCellIndex(bodies, i); });
+}
+
+void HierarchicalGrid::build(const BodyStore& bodies)
+{
+	const int numThreads = static_cast<int>(_threadLevelCounts.size());
+	if (numThreads == 0) return; // not initialised
+
+	const int count = static_cast<int>(bodies.size());
+	const int bodiesPerThread = (count + numThreads - 1) / numThreads;
+	auto begin = [&](int t) { return std::min(t * bodiesPerThread, count); };
+	auto end = [&](int t) { return std::min((t + 1) * bodiesPerThread, count); };
+
+	for (int t = 0; t < numThreads; ++t) countBodies(bodies, begin(t), end(t), t);
+	for (int t = 0; t < numThreads; ++t) sumCells(t, numThreads);
+	for (int t = 0; t < numThreads; ++t) assignOffsets(t, numThreads);
+	for (int t = 0; t < numThreads; ++t) scatterBodies(bodies, begin(t), end(t), t);
+}
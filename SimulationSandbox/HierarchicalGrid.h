@@ -0,0 +1,102 @@
+#pragma once
+#include <vector>
+#include <DirectXMath.h>
+#include "BodyStore.h"
+#include "CellSort.h"
+
+// Stack of uniform grids for scenes with mixed body sizes.
+// Level L has cells of 'finestCellSize * 2^L'; a body goes into the finest level whose
+// cells are at least its diameter, so small bodies no longer share the coarse cells that
+// large ones need. Pairs within a level come from the 3x3x3 cells around a body, pairs
+// across levels are only looked up from the finer body towards the coarser levels.
+// All levels share one counting sort and the same passes as UniformGrid:
+//   countBodies -> sumCells -> assignOffsets -> scatterBodies
+class HierarchicalGrid
+{
+private:
+	struct Level
+	{
+		float cellSize;
+		float inverseCellSize;
+		int cellsX;
+		int cellsY;
+		int cellsZ;
+		int firstCell; // offset of the level's cells in the shared sort
+	};
+
+	static constexpr int MAX_LEVELS = 16;
+
+	std::vector<Level> _levels;
+	DirectX::XMFLOAT3 _worldMin = { 0.0f, 0.0f, 0.0f };
+	DirectX::XMFLOAT3 _worldMax = { 0.0f, 0.0f, 0.0f };
+
+	CellSort _sort; // body store indices sorted by cell, level after level
+
+	// Bodies per level, so queries can skip the empty ones
+	std::vector<std::vector<int>> _threadLevelCounts;
+	std::vector<int> _levelCounts;
+
+	void getCellCoords(const Level& level, float x, float y, float z, int& cellX, int& cellY, int& cellZ) const;
+	int getCellIndex(const Level& level, int cellX, int cellY, int cellZ) const
+	{
+		return level.firstCell + cellX + cellY * level.cellsX + cellZ * level.cellsX * level.cellsY;
+	}
+	int getCellIndex(const BodyStore& bodies, int i) const;
+
+	template <typename Fn>
+	void forEachInLevel(const Level& level, float x, float y, float z, Fn&& fn) const
+	{
+		int centerCellX, centerCellY, centerCellZ;
+		getCellCoords(level, x, y, z, centerCellX, centerCellY, centerCellZ);
+
+		for (int cellZ = std::max(centerCellZ - 1, 0); cellZ <= std::min(centerCellZ + 1, level.cellsZ - 1); ++cellZ)
+			for (int cellY = std::max(centerCellY - 1, 0); cellY <= std::min(centerCellY + 1, level.cellsY - 1); ++cellY)
+				for (int cellX = std::max(centerCellX - 1, 0); cellX <= std::min(centerCellX + 1, level.cellsX - 1); ++cellX)
+				{
+					int cell = getCellIndex(level, cellX, cellY, cellZ);
+					const int* cellBodies = _sort.getCellItems(cell);
+					const int cellCount = _sort.getCellCount(cell);
+					for (int k = 0; k < cellCount; ++k)
+					{
+						fn(cellBodies[k]);
+					}
+				}
+	}
+
+public:
+	void init(float finestCellSize, const DirectX::XMFLOAT3& worldMin, const DirectX::XMFLOAT3& worldMax, int numThreads);
+
+	// Pass 1: per-thread histogram over the body range [begin, end)
+	void countBodies(const BodyStore& bodies, int begin, int end, int threadIndex);
+	// Pass 2: prefix sum over the cells
+	void sumCells(int threadIndex, int numThreads);
+	void assignOffsets(int threadIndex, int numThreads) { _sort.assignOffsets(threadIndex, numThreads); }
+	// Pass 3: write body indices into their cell's run
+	void scatterBodies(const BodyStore& bodies, int begin, int end, int threadIndex);
+
+	void build(const BodyStore& bodies); // single-threaded convenience, runs all passes
+
+	int getLevel(float radius) const;
+
+	// Calls fn(j) once for every body j that may touch body i:
+	// bodies j > i on i's own level and every body on the coarser levels
+	template <typename Fn>
+	void forEachNeighbour(int i, const BodyStore& bodies, Fn&& fn) const
+	{
+		const float x = bodies.posX[i], y = bodies.posY[i], z = bodies.posZ[i];
+		const int bodyLevel = getLevel(bodies.radius[i]);
+
+		forEachInLevel(_levels[bodyLevel], x, y, z, [&](int j) { if (i < j) fn(j); });
+
+		for (int level = bodyLevel + 1; level < static_cast<int>(_levels.size()); ++level)
+		{
+			if (_levelCounts[level] == 0) continue;
+			forEachInLevel(_levels[level], x, y, z, fn);
+		}
+	}
+
+	size_t getNumLevels() const { return _levels.size(); }
+	int getLevelCount(int level) const { return _levelCounts[level]; }
+	float getLevelCellSize(int level) const { return _levels[level].cellSize; }
+	size_t getNumCells() const { return _sort.getNumCells(); }
+};
@@ -0,0 +1,68 @@
+#include "MortonOrder.h"
+#include <algorithm>
+
+void MortonOrder::init(const DirectX::XMFLOAT3& worldMin, const DirectX::XMFLOAT3& worldMax)
+{
+	const float cellsPerAxis = static_cast<float>(1 << BITS_PER_AXIS);
+	_worldMin = worldMin;
+	_inverseCellSize = {
+		cellsPerAxis / std::max(worldMax.x - worldMin.x, 1e-6f),
+		cellsPerAxis / std::max(worldMax.y - worldMin.y, 1e-6f),
+		cellsPerAxis / std::max(worldMax.z - worldMin.z, 1e-6f) };
+}
+
+uint32_t MortonOrder::spreadBits(uint32_t value)
+{
+	// Inserts two zero bits between each of the lowest 10 bits
+	value &= 0x3ff;
+	value = (value | (value << 16)) & 0x030000ff;
+	value = (value | (value << 8)) & 0x0300f00f;
+	value = (value | (value << 4)) & 0x030c30c3;
+	value = (value | (value << 2)) & 0x09249249;
+	return value;
+}
+
+uint32_t MortonOrder::getCode(const BodyStore& bodies, size_t i) const
+{
+	// Bodies outside the world share the border cells
+	const float maxCell = static_cast<float>((1 << BITS_PER_AXIS) - 1);
+	const uint32_t cellX = static_cast<uint32_t>(std::clamp((bodies.posX[i] - _worldMin.x) * _inverseCellSize.x, 0.0f, maxCell));
+	const uint32_t cellY = static_cast<uint32_t>(std::clamp((bodies.posY[i] - _worldMin.y) * _inverseCellSize.y, 0.0f, maxCell));
+	const uint32_t cellZ = static_cast<uint32_t>(std::clamp((bodies.posZ[i] - _worldMin.z) * _inverseCellSize.z, 0.0f, maxCell));
+	return encode(cellX, cellY, cellZ);
+}
+
+float MortonOrder::measureDisorder(const BodyStore& bodies) const
+{
+	const size_t numBodies = bodies.size();
+	if (numBodies < 2) return 0.0f;
+
+	size_t descents = 0;
+	uint32_t previous = getCode(bodies, 0);
+	for (size_t i = 1; i < numBodies; ++i)
+	{
+		const uint32_t code = getCode(bodies, i);
+		if (code < previous) ++descents;
+		previous = code;
+	}
+	return static_cast<float>(descents) / static_cast<float>(numBodies - 1);
+}
+
+void MortonOrder::computeOrder(const BodyStore& bodies, std::vector<int>& order)
+{
+	const size_t numBodies = bodies.size();
+	_keys.resize(numBodies);
+	for (size_t i = 0; i < numBodies; ++i)
+	{
+		_keys[i] = (static_cast<uint64_t>(getCode(bodies, i)) << 32) | static_cast<uint32_t>(i);
+	}
+
+	// The index in the low bits keeps bodies of one cell in their current order
+	std::sort(_keys.begin(), _keys.end());
+
+	order.resize(numBodies);
+	for (size_t k = 0; k < numBodies; ++k)
+	{
+		order[k] = static_cast<int>(_keys[k] & 0xffffffffu);
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <DirectXMath.h>
+#include "BodyStore.h"
+
+// Z-order (Morton) codes of body positions, used to keep bodies that are close in space
+// close in the body store. The world is split into 1024 cells per axis and the cell
+// coordinates are bit-interleaved, so nearby cells get nearby codes.
+class MortonOrder
+{
+private:
+	static constexpr int BITS_PER_AXIS = 10;
+
+	DirectX::XMFLOAT3 _worldMin = { 0.0f, 0.0f, 0.0f };
+	DirectX::XMFLOAT3 _inverseCellSize = { 0.0f, 0.0f, 0.0f };
+	std::vector<uint64_t> _keys; // code << 32 | body index
+
+	static uint32_t spreadBits(uint32_t value);
+	uint32_t getCode(const BodyStore& bodies, size_t i) const;
+
+public:
+	void init(const DirectX::XMFLOAT3& worldMin, const DirectX::XMFLOAT3& worldMax);
+
+	static uint32_t encode(uint32_t cellX, uint32_t cellY, uint32_t cellZ)
+	{
+		return spreadBits(cellX) | (spreadBits(cellY) << 1) | (spreadBits(cellZ) << 2);
+	}
+
+	// Fraction of neighbouring store slots whose codes decrease: 0 when sorted, about 0.5 when shuffled
+	float measureDisorder(const BodyStore& bodies) const;
+
+	// order[k] is the body that should move to slot k
+	void computeOrder(const BodyStore& bodies, std::vector<int>& order);
+};
@@ -1,6 +1,7 @@
 #include "NetworkManager.h"
 #include "network_messages_generated.h"
 #include "globals.h"
+#include "CpuTopology.h"
 #include <windows.h>
 #include <string>
 #include <sstream>
@@ -117,7 +118,7 @@ void NetworkManager::startNetworking() {
 
     _running = true;
     _networkThread = std::thread([this]() {
-        SetThreadAffinityMask(GetCurrentThread(), 1ULL << 2);
+        CpuTopology::get().pinCurrentThread(ThreadRole::NETWORK, 0);
         networkLoop();
         });
 
@@ -165,6 +166,10 @@ void NetworkManager::networkLoop() {
     int senderLen = sizeof(senderAddr);
 
     while (_running) {
+        if (_repinRequested.exchange(false)) {
+            CpuTopology::get().pinCurrentThread(ThreadRole::NETWORK, 0);
+        }
+
         int bytes = recvfrom(_socket, buffer, sizeof(buffer), 0, (sockaddr*)&senderAddr, &senderLen);
         bool messageProcessed = false;
 
@@ -331,7 +336,7 @@ void NetworkManager::handleGlobalState(const char* data, int size)
     const GlobalState* state = msg->data_as_GlobalState();
     if (!state) return;
 
-    globals::isPaused.store(state->is_paused());
+    PhysicsManager::getInstance().setPaused(state->is_paused());
     globals::gravityEnabled.store(state->gravity_enabled());
     globals::gravityY.store(state->gravity_y());
     globals::elasticity.store(state->elasticity());
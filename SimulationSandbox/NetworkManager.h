@@ -24,6 +24,7 @@ private:
     SOCKET _socket = INVALID_SOCKET;
     std::thread _networkThread;
     std::atomic<bool> _running{ false };
+    std::atomic<bool> _repinRequested{ false }; // the network thread pins itself again at its next pass
     std::mutex _recvMutex;
 
     sockaddr_in _selfAddr{};
@@ -77,4 +78,7 @@ public:
     int getLocalPeerId() const { return _localPeerId; }
     int getLocalColour() const { return _localColour; }
     bool isRunning() const { return _running.load(); }
+
+    // After a change of the pinning policy; only the thread itself can move, so it is just asked to
+    void requestRepin() { _repinRequested.store(true); }
 };
\ No newline at end of file
@@ -0,0 +1,786 @@
+#include "PhysicsBenchmark.h"
+#include "BodyStore.h"
+#include "UniformGrid.h"
+#include "HierarchicalGrid.h"
+#include "SpatialHash.h"
+#include "MortonOrder.h"
+#include "SphereNarrowphase.h"
+#include "SweepAndPrune.h"
+#include "CollisionDispatch.h"
+#include "ContactColouring.h"
+#include "TaskScheduler.h"
+#include "PhysicsManager.h"
+#include "Sphere.h"
+#include "Plane.h"
+#include "Cube.h"
+#include "Capsule.h"
+#include "Cylinder.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+std::atomic<bool> PhysicsBenchmark::_running{ false };
+
+namespace
+{
+	using Clock = std::chrono::high_resolution_clock;
+
+	const int bodyCounts[] = { 1000, 10000, 100000 };
+	const float sphereRadius = 0.01f; // Scenario default for minRadius and maxRadius
+	const float gridCellSize = 0.5f;  // same as PhysicsManager::startThreads
+	const float finestCellSize = 0.1f; // hierarchical grid, same as PhysicsManager::startThreads
+	const float largeRadius = 0.4f;   // above half the grid cell, which the uniform grid cannot handle
+
+	enum class BodyLayout
+	{
+		FLOOR, // spread over the whole floor, as Scenario1-5 drop them from the ceiling
+		PILE,  // packed into touching layers, as a settled heap
+		MIXED  // FLOOR with every 100th sphere enlarged to 'largeRadius'
+	};
+
+	const wchar_t* layoutName(BodyLayout layout)
+	{
+		switch (layout)
+		{
+		case BodyLayout::FLOOR: return L"floor";
+		case BodyLayout::PILE: return L"pile";
+		default: return L"mixed";
+		}
+	}
+
+	struct BenchmarkBodies
+	{
+		std::vector<std::unique_ptr<PhysicsObject>> objects; // the store keeps raw pointers to these
+		BodyStore store;
+	};
+
+	// 'axis' is the half size of the world, the scenarios use globals::AXIS_LENGTH
+	void createBodies(BodyLayout layout, int count, std::mt19937& rng, BenchmarkBodies& out, float axis = globals::AXIS_LENGTH)
+	{
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		out.objects.clear();
+		out.objects.reserve(count);
+		out.store.clear();
+		out.store.reserve(count);
+
+		// FLOOR follows Scenario::generateUniform2DPositions: one sphere per cell of a square grid, jittered within its cell
+		const int floorSide = static_cast<int>(ceil(sqrt(static_cast<float>(count))));
+		const float floorCell = (axis * 2.0f) / floorSide;
+		const float floorMargin = std::max(0.0f, floorCell * 0.5f - sphereRadius);
+
+		// PILE uses a fixed spacing of one diameter, so neighbours touch
+		const float spacing = sphereRadius * 2.0f;
+		const int pileSide = std::min(static_cast<int>((axis * 2.0f) / spacing), floorSide);
+
+		for (int i = 0; i < count; ++i)
+		{
+			DirectX::XMFLOAT3 position;
+			float radius = sphereRadius;
+			if (layout == BodyLayout::FLOOR || layout == BodyLayout::MIXED)
+			{
+				int cellX = i / floorSide, cellZ = i % floorSide;
+				position.x = -axis + (cellX + 0.5f) * floorCell + (unit(rng) * 2.0f - 1.0f) * floorMargin;
+				position.z = -axis + (cellZ + 0.5f) * floorCell + (unit(rng) * 2.0f - 1.0f) * floorMargin;
+				position.y = -axis + sphereRadius;
+				if (layout == BodyLayout::MIXED && i % 100 == 0) radius = largeRadius;
+			}
+			else
+			{
+				int layer = i / (pileSide * pileSide);
+				int slot = i % (pileSide * pileSide);
+				position.x = -axis + sphereRadius + (slot / pileSide) * spacing;
+				position.z = -axis + sphereRadius + (slot % pileSide) * spacing;
+				position.y = -axis + sphereRadius + layer * spacing;
+			}
+
+			out.objects.push_back(std::make_unique<PhysicsObject>(
+				std::make_unique<Sphere>(position, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT3(radius, radius, radius)),
+				false, 1.0f, Material::MAT1));
+			out.store.add(*out.objects.back());
+		}
+	}
+
+	// Small random motion per tick, like a pile that is still settling
+	void jitterBodies(BodyStore& bodies, std::mt19937& rng)
+	{
+		std::uniform_real_distribution<float> jitter(-0.1f * sphereRadius, 0.1f * sphereRadius);
+		for (size_t i = 0; i < bodies.size(); ++i)
+		{
+			bodies.posX[i] += jitter(rng);
+			bodies.posY[i] += jitter(rng);
+			bodies.posZ[i] += jitter(rng);
+		}
+	}
+
+	// Same test as SphereNarrowphase
+	bool spheresTouch(const BodyStore& bodies, int a, int b)
+	{
+		float dx = bodies.posX[a] - bodies.posX[b];
+		float dy = bodies.posY[a] - bodies.posY[b];
+		float dz = bodies.posZ[a] - bodies.posZ[b];
+		float sumRadii = bodies.radius[a] + bodies.radius[b];
+		return dx * dx + dy * dy + dz * dz <= sumRadii * sumRadii + 1e-4f;
+	}
+
+	// Collider::isColliding as it was before CollisionDispatch: a virtual call on 'a',
+	// then a dynamic_cast per candidate type until one matches
+	bool legacyIsColliding(const Collider& a, const Collider& b, DirectX::XMFLOAT3& outNormal, float& penetrationDepth)
+	{
+		if (const Sphere* sphere = dynamic_cast<const Sphere*>(&a))
+		{
+			if (const Sphere* other = dynamic_cast<const Sphere*>(&b)) return sphere->isCollidingWithSphere(*other, outNormal, penetrationDepth);
+			if (const Plane* plane = dynamic_cast<const Plane*>(&b)) return sphere->isCollidingWithPlane(*plane, outNormal, penetrationDepth);
+			if (const Cylinder* cylinder = dynamic_cast<const Cylinder*>(&b)) return sphere->isCollidingWithCylinder(*cylinder, outNormal, penetrationDepth);
+			if (const Cube* cube = dynamic_cast<const Cube*>(&b)) return sphere->isCollidingWithCube(*cube, outNormal, penetrationDepth);
+			if (const Capsule* capsule = dynamic_cast<const Capsule*>(&b)) return sphere->isCollidingWithCapsule(*capsule, outNormal, penetrationDepth);
+			return false;
+		}
+		if (const Sphere* sphere = dynamic_cast<const Sphere*>(&b))
+		{
+			bool result = legacyIsColliding(*sphere, a, outNormal, penetrationDepth);
+			outNormal.x = -outNormal.x;
+			outNormal.y = -outNormal.y;
+			outNormal.z = -outNormal.z;
+			return result;
+		}
+		return false;
+	}
+
+	float elapsedMs(Clock::time_point start)
+	{
+		return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+	}
+
+	void log(const std::wstringstream& wss)
+	{
+		OutputDebugString(wss.str().c_str());
+	}
+}
+
+void PhysicsBenchmark::runAsync(std::function<void()> benchmark)
+{
+	bool expected = false;
+	if (!_running.compare_exchange_strong(expected, true))
+	{
+		OutputDebugString(L"[BENCHMARK] A benchmark is already running.\n");
+		return;
+	}
+
+	std::thread([benchmark = std::move(benchmark)]() {
+		benchmark();
+		_running = false;
+		}).detach();
+}
+
+void PhysicsBenchmark::runBroadphase()
+{
+	const float axis = globals::AXIS_LENGTH;
+	std::mt19937 rng(7);
+
+	OutputDebugString(L"[BENCHMARK] Broadphase: uniform grid vs hierarchical grid vs sweep-and-prune (ms per tick, contacts found)\n");
+
+	for (BodyLayout layout : { BodyLayout::FLOOR, BodyLayout::PILE, BodyLayout::MIXED })
+	{
+		for (int count : bodyCounts)
+		{
+			BenchmarkBodies bodies;
+			createBodies(layout, count, rng, bodies);
+
+			UniformGrid grid;
+			grid.init(gridCellSize, { -axis, -axis, -axis }, { axis, axis, axis }, 1);
+
+			HierarchicalGrid hierarchicalGrid;
+			hierarchicalGrid.init(finestCellSize, { -axis, -axis, -axis }, { axis, axis, axis }, 1);
+
+			SweepAndPrune sweepAndPrune;
+			auto start = Clock::now();
+			sweepAndPrune.update(bodies.store); // first update sorts from scratch
+			const float sapBuildMs = elapsedMs(start);
+
+			// Fewer ticks for the big cases, the grid alone takes a while there
+			const int ticks = std::max(5, 200000 / count);
+			float gridMs = 0.0f, hierarchicalMs = 0.0f, sapMs = 0.0f;
+			int gridContacts = 0, hierarchicalContacts = 0, sapContacts = 0;
+
+			for (int tick = 0; tick < ticks; ++tick)
+			{
+				jitterBodies(bodies.store, rng);
+
+				gridContacts = 0;
+				start = Clock::now();
+				grid.build(bodies.store);
+				for (int i = 0; i < count; ++i)
+				{
+					const BodyStore& store = bodies.store;
+					grid.forEachNeighbour(i, store.posX[i], store.posY[i], store.posZ[i], [&](int j)
+						{
+							if (spheresTouch(store, i, j)) ++gridContacts;
+						});
+				}
+				gridMs += elapsedMs(start);
+
+				hierarchicalContacts = 0;
+				start = Clock::now();
+				hierarchicalGrid.build(bodies.store);
+				for (int i = 0; i < count; ++i)
+				{
+					hierarchicalGrid.forEachNeighbour(i, bodies.store, [&](int j)
+						{
+							if (spheresTouch(bodies.store, i, j)) ++hierarchicalContacts;
+						});
+				}
+				hierarchicalMs += elapsedMs(start);
+
+				sapContacts = 0;
+				start = Clock::now();
+				sweepAndPrune.update(bodies.store);
+				for (size_t k = 0; k < sweepAndPrune.getPairCount(); ++k)
+				{
+					int a, b;
+					sweepAndPrune.getPair(k, a, b);
+					if (spheresTouch(bodies.store, a, b)) ++sapContacts;
+				}
+				sapMs += elapsedMs(start);
+			}
+
+			std::wstringstream wss;
+			wss << L"[BENCHMARK] " << layoutName(layout) << L" n=" << count
+				<< L" grid " << gridMs / ticks << L" ms (" << gridContacts << L")"
+				<< L" hgrid " << hierarchicalMs / ticks << L" ms (" << hierarchicalContacts << L")"
+				<< L" sap " << sapMs / ticks << L" ms (" << sapContacts << L", "
+				<< sweepAndPrune.getPairCount() << L" boxes, first sort " << sapBuildMs << L" ms)\n";
+			log(wss);
+		}
+	}
+
+	OutputDebugString(L"[BENCHMARK] Broadphase done.\n");
+}
+
+void PhysicsBenchmark::runLargeWorld()
+{
+	const float worldScales[] = { 1.0f, 10.0f, 100.0f };
+	const size_t maxDenseCells = 16 * 1024 * 1024; // beyond this the dense grid is not even allocated
+	std::mt19937 rng(11);
+
+	OutputDebugString(L"[BENCHMARK] Large worlds: uniform grid vs spatial hash (ms per tick, cells)\n");
+
+	for (float scale : worldScales)
+	{
+		const float axis = globals::AXIS_LENGTH * scale;
+		const int count = 100000;
+
+		BenchmarkBodies bodies;
+		createBodies(BodyLayout::FLOOR, count, rng, bodies, axis);
+
+		const size_t cellsPerAxis = static_cast<size_t>(ceil(axis * 2.0f / gridCellSize));
+		const size_t denseCells = cellsPerAxis * cellsPerAxis * cellsPerAxis;
+		const bool runGrid = denseCells <= maxDenseCells;
+
+		UniformGrid grid;
+		if (runGrid) grid.init(gridCellSize, { -axis, -axis, -axis }, { axis, axis, axis }, 1);
+
+		SpatialHash spatialHash;
+		spatialHash.init(gridCellSize);
+
+		const int ticks = 5;
+		float gridMs = 0.0f, hashMs = 0.0f;
+		int gridContacts = 0, hashContacts = 0;
+
+		for (int tick = 0; tick < ticks; ++tick)
+		{
+			jitterBodies(bodies.store, rng);
+			const BodyStore& store = bodies.store;
+
+			if (runGrid)
+			{
+				gridContacts = 0;
+				auto start = Clock::now();
+				grid.build(store);
+				for (int i = 0; i < count; ++i)
+				{
+					grid.forEachNeighbour(i, store.posX[i], store.posY[i], store.posZ[i], [&](int j)
+						{
+							if (spheresTouch(store, i, j)) ++gridContacts;
+						});
+				}
+				gridMs += elapsedMs(start);
+			}
+
+			hashContacts = 0;
+			auto start = Clock::now();
+			spatialHash.build(store);
+			for (int i = 0; i < count; ++i)
+			{
+				spatialHash.forEachNeighbour(i, store.posX[i], store.posY[i], store.posZ[i], [&](int j)
+					{
+						if (spheresTouch(store, i, j)) ++hashContacts;
+					});
+			}
+			hashMs += elapsedMs(start);
+		}
+
+		std::wstringstream wss;
+		wss << L"[BENCHMARK] world x" << scale << L" n=" << count << L" grid ";
+		if (runGrid) wss << gridMs / ticks << L" ms (" << gridContacts << L", " << denseCells << L" cells)";
+		else wss << L"skipped (" << denseCells << L" cells)";
+		wss << L" hash " << hashMs / ticks << L" ms (" << hashContacts << L", " << spatialHash.getOccupiedCells()
+			<< L" occupied, " << spatialHash.getCapacity() << L" slots)\n";
+		log(wss);
+	}
+
+	OutputDebugString(L"[BENCHMARK] Large worlds done.\n");
+}
+
+void PhysicsBenchmark::runReorder()
+{
+	const float axis = globals::AXIS_LENGTH;
+	std::mt19937 rng(13);
+
+	OutputDebugString(L"[BENCHMARK] Morton reorder: shuffled vs sorted body store (ms per tick, mean index gap of contacts)\n");
+
+	for (int count : bodyCounts)
+	{
+		BenchmarkBodies bodies;
+		createBodies(BodyLayout::PILE, count, rng, bodies);
+
+		// Spawn order is random (generateUniform2DPositions), so start from a shuffled store
+		std::vector<int> order(count);
+		for (int i = 0; i < count; ++i) order[i] = i;
+		std::shuffle(order.begin(), order.end(), rng);
+		bodies.store.reorder(order);
+
+		MortonOrder mortonOrder;
+		mortonOrder.init({ -axis, -axis, -axis }, { axis, axis, axis });
+
+		HierarchicalGrid hierarchicalGrid;
+		hierarchicalGrid.init(finestCellSize, { -axis, -axis, -axis }, { axis, axis, axis }, 1);
+
+		// Broadphase plus the sphere test, the part that reads other bodies' state
+		auto measure = [&](float& ms, double& meanGap)
+			{
+				const int ticks = std::max(5, 100000 / count);
+				const BodyStore& store = bodies.store;
+				long long contacts = 0, gapSum = 0;
+
+				auto start = Clock::now();
+				for (int tick = 0; tick < ticks; ++tick)
+				{
+					contacts = 0; gapSum = 0;
+					hierarchicalGrid.build(store);
+					for (int i = 0; i < count; ++i)
+					{
+						hierarchicalGrid.forEachNeighbour(i, store, [&](int j)
+							{
+								if (spheresTouch(store, i, j)) { ++contacts; gapSum += std::abs(j - i); }
+							});
+					}
+				}
+				ms = elapsedMs(start) / ticks;
+				meanGap = contacts > 0 ? static_cast<double>(gapSum) / contacts : 0.0;
+			};
+
+		float shuffledMs, sortedMs;
+		double shuffledGap, sortedGap;
+		const float shuffledDisorder = mortonOrder.measureDisorder(bodies.store);
+		measure(shuffledMs, shuffledGap);
+
+		auto start = Clock::now();
+		mortonOrder.computeOrder(bodies.store, order);
+		bodies.store.reorder(order);
+		const float reorderMs = elapsedMs(start);
+
+		const float sortedDisorder = mortonOrder.measureDisorder(bodies.store);
+		measure(sortedMs, sortedGap);
+
+		std::wstringstream wss;
+		wss << L"[BENCHMARK] n=" << count
+			<< L" shuffled " << shuffledMs << L" ms (gap " << shuffledGap << L", disorder " << shuffledDisorder << L")"
+			<< L" sorted " << sortedMs << L" ms (gap " << sortedGap << L", disorder " << sortedDisorder << L")"
+			<< L" reorder " << reorderMs << L" ms\n";
+		log(wss);
+	}
+
+	OutputDebugString(L"[BENCHMARK] Morton reorder done.\n");
+}
+
+void PhysicsBenchmark::runStencil()
+{
+	const float axis = globals::AXIS_LENGTH;
+	std::mt19937 rng(17);
+
+	OutputDebugString(L"[BENCHMARK] Grid stencil: 27-cell scan vs 13-cell half stencil (ms per tick, candidates, contacts)\n");
+
+	for (BodyLayout layout : { BodyLayout::FLOOR, BodyLayout::PILE })
+	{
+		for (int count : bodyCounts)
+		{
+			BenchmarkBodies bodies;
+			createBodies(layout, count, rng, bodies);
+			const BodyStore& store = bodies.store;
+
+			UniformGrid grid;
+			grid.init(gridCellSize, { -axis, -axis, -axis }, { axis, axis, axis }, 1);
+			grid.build(store);
+
+			// Only the pair enumeration differs, so the grid is built once
+			const int ticks = std::max(3, 100000 / count);
+			long long fullCandidates = 0, halfCandidates = 0;
+			int fullContacts = 0, halfContacts = 0;
+
+			auto start = Clock::now();
+			for (int tick = 0; tick < ticks; ++tick)
+			{
+				fullCandidates = 0; fullContacts = 0;
+				for (int i = 0; i < count; ++i)
+				{
+					grid.forEachNeighbour(i, store.posX[i], store.posY[i], store.posZ[i], [&](int j)
+						{
+							++fullCandidates;
+							if (spheresTouch(store, i, j)) ++fullContacts;
+						});
+				}
+			}
+			const float fullMs = elapsedMs(start) / ticks;
+
+			start = Clock::now();
+			for (int tick = 0; tick < ticks; ++tick)
+			{
+				halfCandidates = 0; halfContacts = 0;
+				grid.forEachCellPair(0, 1, [&](int a, int b)
+					{
+						++halfCandidates;
+						if (spheresTouch(store, a, b)) ++halfContacts;
+					});
+			}
+			const float halfMs = elapsedMs(start) / ticks;
+
+			std::wstringstream wss;
+			wss << L"[BENCHMARK] " << layoutName(layout) << L" n=" << count
+				<< L" full " << fullMs << L" ms (" << fullCandidates << L", " << fullContacts << L")"
+				<< L" half " << halfMs << L" ms (" << halfCandidates << L", " << halfContacts << L")\n";
+			log(wss);
+		}
+	}
+
+	OutputDebugString(L"[BENCHMARK] Grid stencil done.\n");
+}
+
+void PhysicsBenchmark::runNarrowphase()
+{
+	const float axis = globals::AXIS_LENGTH;
+	std::mt19937 rng(19);
+
+	std::wstringstream header;
+	header << L"[BENCHMARK] Sphere narrowphase per SIMD level (ns per candidate, contacts), CPU supports "
+		<< SphereNarrowphase::getLevelName(SphereNarrowphase::getSupportedLevel()) << L"\n";
+	log(header);
+
+	for (BodyLayout layout : { BodyLayout::FLOOR, BodyLayout::PILE })
+	{
+		for (int count : bodyCounts)
+		{
+			BenchmarkBodies bodies;
+			createBodies(layout, count, rng, bodies);
+			const BodyStore& store = bodies.store;
+
+			// Candidates as the default broadphase hands them out, capped to keep memory in check
+			UniformGrid grid;
+			grid.init(gridCellSize, { -axis, -axis, -axis }, { axis, axis, axis }, 1);
+			grid.build(store);
+
+			const size_t maxCandidates = 20000000;
+			std::vector<int> bodiesA, bodiesB;
+			grid.forEachCellPair(0, 1, [&](int a, int b)
+				{
+					if (bodiesA.size() < maxCandidates) { bodiesA.push_back(a); bodiesB.push_back(b); }
+				});
+			const int numCandidates = static_cast<int>(bodiesA.size());
+
+			std::wstringstream wss;
+			wss << L"[BENCHMARK] " << layoutName(layout) << L" n=" << count << L" candidates=" << numCandidates;
+
+			SphereNarrowphase narrowphase;
+			std::vector<SphereContact> contacts;
+			for (SimdLevel level : { SimdLevel::SCALAR, SimdLevel::SSE, SimdLevel::AVX2, SimdLevel::AVX512 })
+			{
+				if (static_cast<int>(level) > static_cast<int>(SphereNarrowphase::getSupportedLevel())) break;
+				narrowphase.setLevel(level);
+
+				const int repeats = std::max(1, 2000000 / std::max(numCandidates, 1));
+				auto start = Clock::now();
+				for (int repeat = 0; repeat < repeats; ++repeat)
+				{
+					contacts.clear();
+					for (int k = 0; k < numCandidates; k += SphereNarrowphase::BATCH_SIZE)
+					{
+						const int batchSize = std::min(SphereNarrowphase::BATCH_SIZE, numCandidates - k);
+						narrowphase.test(store, bodiesA.data() + k, bodiesB.data() + k, batchSize, contacts);
+					}
+				}
+				const float ns = elapsedMs(start) * 1e6f / (static_cast<float>(repeats) * std::max(numCandidates, 1));
+
+				wss << L" " << SphereNarrowphase::getLevelName(level) << L" " << ns << L" (" << contacts.size() << L")";
+			}
+			wss << L"\n";
+			log(wss);
+		}
+	}
+
+	OutputDebugString(L"[BENCHMARK] Sphere narrowphase done.\n");
+}
+
+void PhysicsBenchmark::runDispatch()
+{
+	std::mt19937 rng(23);
+	std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+
+	// One collider of every kind, placed so that some of the spheres touch each of them
+	std::vector<std::unique_ptr<Collider>> shapes;
+	shapes.push_back(std::make_unique<Sphere>(DirectX::XMFLOAT3{ 0.0f, 0.0f, 0.0f }, DirectX::XMFLOAT3{ 0.0f, 0.0f, 0.0f }, DirectX::XMFLOAT3{ 0.5f, 0.5f, 0.5f }));
+	shapes.push_back(std::make_unique<Plane>(DirectX::XMFLOAT3{ 0.0f, 0.0f, 0.0f }));
+	shapes.push_back(std::make_unique<Cube>(DirectX::XMFLOAT3{ 0.0f, 0.0f, 0.0f }));
+	shapes.push_back(std::make_unique<Capsule>(DirectX::XMFLOAT3{ 0.0f, 0.0f, 0.0f }, DirectX::XMFLOAT3{ 0.0f, 0.0f, 0.0f }, DirectX::XMFLOAT3{ 0.5f, 1.0f, 0.5f }));
+	shapes.push_back(std::make_unique<Cylinder>(DirectX::XMFLOAT3{ 0.0f, 0.0f, 0.0f }, DirectX::XMFLOAT3{ 0.0f, 0.0f, 0.0f }, DirectX::XMFLOAT3{ 0.5f, 1.0f, 0.5f }));
+	const wchar_t* shapeNames[] = { L"sphere", L"plane", L"cube", L"capsule", L"cylinder" };
+
+	const int numSpheres = 1024;
+	std::vector<std::unique_ptr<Sphere>> spheres;
+	for (int i = 0; i < numSpheres; ++i)
+	{
+		spheres.push_back(std::make_unique<Sphere>(DirectX::XMFLOAT3{ position(rng), position(rng), position(rng) },
+			DirectX::XMFLOAT3{ 0.0f, 0.0f, 0.0f }, DirectX::XMFLOAT3{ 0.1f, 0.1f, 0.1f }));
+	}
+
+	OutputDebugString(L"[BENCHMARK] Collision dispatch (ns per test, hits), dynamic_cast chain against the shape table\n");
+
+	const int repeats = 2000;
+	for (size_t s = 0; s < shapes.size(); ++s)
+	{
+		// Both orders, the second one is how the fixed-body pass and the other shapes used to dispatch
+		for (bool sphereFirst : { true, false })
+		{
+			std::wstringstream wss;
+			wss << L"[BENCHMARK] " << (sphereFirst ? L"sphere-" : L"") << shapeNames[s] << (sphereFirst ? L"" : L"-sphere");
+
+			for (bool useTable : { false, true })
+			{
+				int hits = 0;
+				DirectX::XMFLOAT3 normal;
+				float depth;
+				auto start = Clock::now();
+				for (int repeat = 0; repeat < repeats; ++repeat)
+				{
+					for (const auto& sphere : spheres)
+					{
+						const Collider& a = sphereFirst ? static_cast<const Collider&>(*sphere) : *shapes[s];
+						const Collider& b = sphereFirst ? *shapes[s] : static_cast<const Collider&>(*sphere);
+						hits += (useTable ? a.isColliding(b, normal, depth) : legacyIsColliding(a, b, normal, depth)) ? 1 : 0;
+					}
+				}
+				const float ns = elapsedMs(start) * 1e6f / (static_cast<float>(repeats) * numSpheres);
+
+				wss << (useTable ? L" table " : L" dynamic_cast ") << ns << L" (" << hits / repeats << L")";
+			}
+			wss << L"\n";
+			log(wss);
+		}
+	}
+
+	OutputDebugString(L"[BENCHMARK] Collision dispatch done.\n");
+}
+
+void PhysicsBenchmark::runContactColouring()
+{
+	const float axis = globals::AXIS_LENGTH;
+	std::mt19937 rng(29);
+
+	OutputDebugString(L"[BENCHMARK] Contact colouring of a settled pile (colours, parallel colours, pairs left serial, ms per build)\n");
+
+	for (int count : bodyCounts)
+	{
+		BenchmarkBodies bodies;
+		createBodies(BodyLayout::PILE, count, rng, bodies);
+		const BodyStore& store = bodies.store;
+
+		UniformGrid grid;
+		grid.init(gridCellSize, { -axis, -axis, -axis }, { axis, axis, axis }, 1);
+		grid.build(store);
+
+		SphereNarrowphase narrowphase;
+		std::vector<SphereContact> contacts;
+		SpherePairBatch batch(narrowphase, store, contacts);
+		grid.forEachCellPair(0, 1, [&](int a, int b) { batch.add(a, b); });
+		batch.flush();
+
+		std::vector<CollisionPair> pairs;
+		for (const SphereContact& contact : contacts)
+		{
+			pairs.push_back({ contact.bodyA, contact.bodyB, false, { contact.normalX, contact.normalY, contact.normalZ }, contact.depth, {} });
+		}
+		const int numThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+		ContactColouring colouring;
+		const size_t minParallelPairs = 64 * static_cast<size_t>(numThreads); // as PhysicsManager
+		const int repeats = std::max(1, 1000000 / std::max(static_cast<int>(contacts.size()), 1));
+		auto start = Clock::now();
+		for (int repeat = 0; repeat < repeats; ++repeat)
+		{
+			colouring.build(pairs, count, minParallelPairs);
+		}
+		const float buildMs = elapsedMs(start) / repeats;
+
+		std::wstringstream wss;
+		wss << L"[BENCHMARK] pile n=" << count << L" contacts=" << contacts.size() << L" threads=" << numThreads
+			<< L" colours=" << colouring.getNumColours()
+			<< L" parallel=" << colouring.getNumParallelColours()
+			<< L" serial=" << (colouring.getPairs().size() - colouring.getSerialStart())
+			<< L" build=" << buildMs << L"ms\n";
+		log(wss);
+	}
+
+	OutputDebugString(L"[BENCHMARK] Contact colouring done.\n");
+}
+
+void PhysicsBenchmark::runTaskScheduler()
+{
+	const float axis = globals::AXIS_LENGTH;
+	std::mt19937 rng(31);
+
+	OutputDebugString(L"[BENCHMARK] Task scheduler: chunked grid pairs and sphere tests on a pile (workers, ms per pass, speedup)\n");
+
+	const int maxWorkers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	std::vector<int> workerCounts;
+	for (int workers = 1; workers < maxWorkers; workers *= 2) workerCounts.push_back(workers);
+	workerCounts.push_back(maxWorkers);
+
+	for (int count : bodyCounts)
+	{
+		BenchmarkBodies bodies;
+		createBodies(BodyLayout::PILE, count, rng, bodies);
+		const BodyStore& store = bodies.store;
+
+		UniformGrid grid;
+		grid.init(gridCellSize, { -axis, -axis, -axis }, { axis, axis, axis }, 1);
+		grid.build(store);
+
+		SphereNarrowphase narrowphase;
+		const int passes = std::max(3, 200000 / count);
+		float singleMs = 0.0f;
+		for (int workers : workerCounts)
+		{
+			// Chunks as in PhysicsManager, each with its own contact list
+			const int numChunks = workers > 1 ? workers * 4 : 1;
+			std::vector<std::vector<SphereContact>> chunkContacts(numChunks);
+
+			TaskScheduler scheduler;
+			scheduler.start(workers, nullptr);
+
+			size_t numContacts = 0;
+			auto start = Clock::now();
+			for (int pass = 0; pass < passes; ++pass)
+			{
+				scheduler.parallelFor(0, numChunks, 1, [&](int first, int last)
+					{
+						for (int chunk = first; chunk < last; ++chunk)
+						{
+							std::vector<SphereContact>& contacts = chunkContacts[chunk];
+							contacts.clear();
+							SpherePairBatch batch(narrowphase, store, contacts);
+							grid.forEachCellPair(chunk, numChunks, [&](int a, int b) { batch.add(a, b); });
+							batch.flush();
+						}
+					});
+			}
+			const float passMs = elapsedMs(start) / passes;
+			scheduler.stop();
+
+			for (const auto& contacts : chunkContacts) numContacts += contacts.size();
+			if (workers == 1) singleMs = passMs;
+
+			std::wstringstream wss;
+			wss << L"[BENCHMARK] pile n=" << count << L" workers=" << workers << L" contacts=" << numContacts
+				<< L" " << passMs << L" ms x" << (passMs > 0.0f ? singleMs / passMs : 0.0f) << L"\n";
+			log(wss);
+		}
+	}
+
+	OutputDebugString(L"[BENCHMARK] Task scheduler done.\n");
+}
+
+void PhysicsBenchmark::runDeterminism()
+{
+	const float axis = globals::AXIS_LENGTH;
+	const int count = 2000;
+	const int ticks = 500;
+	const float dt = 1.0f / 125.0f; // the default target frequency
+
+	// Gravity, integration and materials at their defaults, whatever the live simulation uses
+	const TickSettings settings;
+
+	OutputDebugString(L"[BENCHMARK] Determinism: seeded drop into a closed box (workers, state hash, sleeping bodies)\n");
+
+	// The same counts on every machine; more workers than cores only makes it slower
+	const int workerCounts[] = { 1, 2, 4, 8 };
+
+	uint64_t firstHash = 0;
+	bool identical = true;
+	for (int workers : workerCounts)
+	{
+		// A fresh simulation every time, built in the same order from the same seed
+		PhysicsManager simulation;
+		auto addWall = [&](DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 normal)
+			{
+				simulation.addObject(std::make_shared<PhysicsObject>(
+					std::make_unique<Plane>(position, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f), normal),
+					true, 100.0f, Material::MAT4));
+			};
+		addWall({ 0.0f, 0.0f, -axis }, { 0.0f, 0.0f, 1.0f });
+		addWall({ 0.0f, 0.0f, axis }, { 0.0f, 0.0f, -1.0f });
+		addWall({ -axis, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f });
+		addWall({ axis, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f });
+		addWall({ 0.0f, -axis, 0.0f }, { 0.0f, 1.0f, 0.0f });
+		addWall({ 0.0f, axis, 0.0f }, { 0.0f, -1.0f, 0.0f });
+
+		std::mt19937 rng(37);
+		std::uniform_real_distribution<float> position(-axis + 0.2f, axis - 0.2f);
+		std::uniform_real_distribution<float> radius(0.05f, 0.1f);
+		for (int i = 0; i < count; ++i)
+		{
+			const float r = radius(rng);
+			const DirectX::XMFLOAT3 start = { position(rng), position(rng), position(rng) };
+			auto object = std::make_shared<PhysicsObject>(
+				std::make_unique<Sphere>(start, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT3(r, r, r)),
+				false, 1.0f, Material::MAT1);
+			object->setObjectId(i);
+			object->setIsOwned(true);
+			simulation.addObject(object);
+		}
+
+		auto start = Clock::now();
+		simulation.runTicks(workers, dt, ticks, settings);
+		const float runMs = elapsedMs(start);
+
+		const uint64_t hash = simulation.getStateHash();
+		if (workers == workerCounts[0]) firstHash = hash;
+		identical = identical && hash == firstHash;
+
+		std::wstringstream wss;
+		wss << L"[BENCHMARK] n=" << count << L" ticks=" << ticks << L" workers=" << workers
+			<< L" hash=" << std::hex << std::setw(16) << std::setfill(L'0') << hash << std::dec
+			<< L" sleeping=" << simulation.getNumSleeping()
+			<< L" " << runMs << L" ms" << (hash == firstHash ? L"\n" : L" MISMATCH\n");
+		log(wss);
+		simulation.clearObjects();
+	}
+
+	OutputDebugString(identical ? L"[BENCHMARK] Determinism done, every worker count gave the same state.\n" : L"[BENCHMARK] Determinism done, the states differ.\n");
+}
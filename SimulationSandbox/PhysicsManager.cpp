@@ -1,7 +1,10 @@
 #include "NetworkManager.h"
 #include "PhysicsManager.h"
+#include "Sphere.h"
 #include <algorithm>
+#include <cmath>
 #include <chrono>
+#include <cstring>
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 #include "globals.h"
@@ -36,15 +39,95 @@ void PhysicsManager::addObject(std::shared_ptr<PhysicsObject> obj)
 		_objectIDMap[objId] = obj;
 	}
 
-	std::unique_lock lock(_objectsMutex);
+	PhysicsObject* rawObj = obj.get();
+	{
+		std::unique_lock lock(_objectsMutex);
+		if (obj->getFixed())
+		{
+			_fixedObjects.push_back(std::move(obj));
+		}
+		else
+		{
+			_movingObjects.push_back(std::move(obj));
+		}
+	}
+
+	// The body store belongs to the simulation threads while they run,
+	// so new objects are handed over at the next tick boundary.
+	if (_running.load())
+	{
+		std::scoped_lock lock(_pendingMutex);
+		_pendingObjects.push_back(rawObj);
+	}
+	else
+	{
+		addToSimulation(rawObj);
+	}
+}
+
+void PhysicsManager::addToSimulation(PhysicsObject* obj)
+{
 	if (obj->getFixed())
 	{
-		_fixedObjects.push_back(std::move(obj));
+		_fixedBodies.push_back({ obj->getColliderPtr(), obj->getMaterial() });
+		_fixedBVHDirty = true;
 	}
 	else
 	{
-		_movingObjects.push_back(std::move(obj));
+		_bodies.add(*obj);
+	}
+}
+
+void PhysicsManager::applyPendingChanges()
+{
+	std::vector<PhysicsObject*> objects;
+	std::vector<RemoteBodyState> remoteStates;
+	{
+		std::scoped_lock lock(_pendingMutex);
+		objects.swap(_pendingObjects);
+		remoteStates.swap(_pendingRemoteStates);
+	}
+
+	for (PhysicsObject* obj : objects)
+	{
+		addToSimulation(obj);
+	}
+	if (_fixedBVHDirty) buildFixedBVH();
+
+	for (const auto& state : remoteStates)
+	{
+		int i = state.object->getBodyIndex();
+		if (i < 0 || _bodies.isOwned(i)) continue;
+
+		_bodies.posX[i] = state.position.x; _bodies.posY[i] = state.position.y; _bodies.posZ[i] = state.position.z;
+		_bodies.rotX[i] = state.rotation.x; _bodies.rotY[i] = state.rotation.y; _bodies.rotZ[i] = state.rotation.z;
+		_bodies.velX[i] = state.velocity.x; _bodies.velY[i] = state.velocity.y; _bodies.velZ[i] = state.velocity.z;
+	}
+}
+
+void PhysicsManager::buildFixedBVH()
+{
+	std::vector<int> ids;
+	std::vector<DirectX::XMFLOAT3> boundsMin, boundsMax;
+	_unboundedFixedBodies.clear();
+
+	for (int f = 0; f < static_cast<int>(_fixedBodies.size()); ++f)
+	{
+		DirectX::XMFLOAT3 fixedMin, fixedMax;
+		if (_fixedBodies[f].collider && _fixedBodies[f].collider->getBounds(fixedMin, fixedMax))
+		{
+			ids.push_back(f);
+			boundsMin.push_back(fixedMin);
+			boundsMax.push_back(fixedMax);
+		}
+		else
+		{
+			_unboundedFixedBodies.push_back(f);
+		}
 	}
+
+	_fixedBVH.build(ids, boundsMin, boundsMax);
+	_fixedBVHDirty = false;
 }
 
 void PhysicsManager::clearObjects()
@@ -53,28 +136,40 @@ void PhysicsManager::clearObjects()
 	_objectIDMap.clear();
 	mapLock.unlock();
 
+	{
+		std::scoped_lock pendingLock(_pendingMutex);
+		_pendingObjects.clear();
+		_pendingRemoteStates.clear();
+	}
+
 	std::unique_lock lock(_objectsMutex);
+	_bodies.clear();
+	_numSleeping.store(0);
+	_fixedBodies.clear();
+	_fixedBVH.clear();
+	_unboundedFixedBodies.clear();
+	_fixedBVHDirty = false;
+	_sweepAndPrune.reset();
+	_spatialHash.clear();
+	_sweepHash.clear();
 	_movingObjects.clear();
 	_fixedObjects.clear();
 
-	if (!_grid.empty())
-	{
-		for (auto& cell : _grid) { cell.clear(); }
-	}
-	if (!_threadMovingPairs.empty())
-	{
-		for (auto& pair_list : _threadMovingPairs) { pair_list.clear(); }
-	}
-	if (!_threadFixedPairs.empty())
-	{
-		for (auto& pair_list : _threadFixedPairs) { pair_list.clear(); }
-	}
-	if (!_threadCollisionPairs.empty()) { for (auto& pair_list : _threadCollisionPairs) pair_list.clear(); }
+	if (!_chunkCollisionPairs.empty()) { for (auto& pair_list : _chunkCollisionPairs) pair_list.clear(); }
 
-	_threadCollisionPairs.clear();
-	_allCollisionPairs.clear();
-	_allMovingPairs.clear();
-	_allFixedPairs.clear();
+	_chunkCollisionPairs.clear();
+	for (auto& pair_list : _mergedPairs) pair_list.clear();
+	_chunkSphereContacts.clear();
+	_chunkSweptBodies.clear();
+	_contactIslands.clear();
+	_contactColouring.clear();
+	_contactCache.clear();
+	_numCachedContacts.store(0);
+	_islandContacts.clear();
+	_colouredContacts.clear();
+	_solverBodies.clear();
+
+	publishSnapshot();
 }
 
 void PhysicsManager::accessAllObjects(const std::function<void(
@@ -86,278 +181,1282 @@ void PhysicsManager::accessAllObjects(const std::function<void(
 	accessor(_movingObjects, _fixedObjects);
 }
 
-void PhysicsManager::initGrid(float cellSize, const DirectX::XMFLOAT3& worldMin, const DirectX::XMFLOAT3& worldMax)
+bool PhysicsManager::testFixedBody(int body, const FixedBody& fixed, DirectX::XMFLOAT3& outNormal, float& penetrationDepth) const
 {
-	_cellSize = cellSize;
-	_worldMin = worldMin;
-	_worldMax = worldMax;
-	DirectX::XMFLOAT3 worldSize = { worldMax.x - worldMin.x, worldMax.y - worldMin.y, worldMax.z - worldMin.z };
-	_gridCellsX = static_cast<int>(ceil(worldSize.x / _cellSize));
-	_gridCellsY = static_cast<int>(ceil(worldSize.y / _cellSize));
-	_gridCellsZ = static_cast<int>(ceil(worldSize.z / _cellSize));
-	size_t totalCells = (size_t)_gridCellsX * _gridCellsY * _gridCellsZ;
-	_grid.assign(totalCells, std::vector<int>());
-	_gridMutexes = std::vector<std::mutex>(totalCells);
+	if (!fixed.collider) return false;
+
+	// The normal points from the fixed collider towards the body, as in Sphere::isColliding
+	float r = _bodies.radius[body];
+	Sphere probe(_bodies.getPosition(body), { 0.0f, 0.0f, 0.0f }, { r, r, r });
+	return probe.isColliding(*fixed.collider, outNormal, penetrationDepth);
 }
 
-int PhysicsManager::getGridIndex(const DirectX::XMFLOAT3& position) const
+DirectX::XMFLOAT3 PhysicsManager::getContactPoint(int body, const DirectX::XMFLOAT3& normal, float depth) const
 {
-	float x = std::clamp(position.x, _worldMin.x, _worldMax.x - 0.001f);
-	float y = std::clamp(position.y, _worldMin.y, _worldMax.y - 0.001f);
-	float z = std::clamp(position.z, _worldMin.z, _worldMax.z - 0.001f);
-	int cellX = static_cast<int>((x - _worldMin.x) / _cellSize);
-	int cellY = static_cast<int>((y - _worldMin.y) / _cellSize);
-	int cellZ = static_cast<int>((z - _worldMin.z) / _cellSize);
-	return cellX + cellY * _gridCellsX + cellZ * _gridCellsX * _gridCellsY;
+	// The surface of the body along -normal, moved back by half the overlap
+	const float distance = _bodies.radius[body] - 0.5f * depth;
+	return { _bodies.posX[body] - normal.x * distance, _bodies.posY[body] - normal.y * distance, _bodies.posZ[body] - normal.z * distance };
 }
 
-void PhysicsManager::simulationLoop(int threadIndex, int numThreads, float dt)
+uint64_t PhysicsManager::getContactKey(const CollisionPair& pair, bool& flipped) const
 {
-	//if (globals::isPaused) return; // Skip simulation if paused
+	const int objectIdA = _bodies.objectId[pair.bodyA];
+	if (pair.bIsFixed)
+	{
+		flipped = false;
+		return ContactCache::makeFixedKey(objectIdA, pair.bodyB);
+	}
 
-	static std::chrono::high_resolution_clock::time_point _lastSimTime;
+	const int objectIdB = _bodies.objectId[pair.bodyB];
+	flipped = objectIdA > objectIdB; // the cache holds the impulse on the lower id
+	return ContactCache::makeKey(objectIdA, objectIdB);
+}
 
-	auto frameStart = std::chrono::high_resolution_clock::now();
+void PhysicsManager::prepareContact(const CollisionPair& pair, PairContact& contact)
+{
+	contact = {};
 
-	// Create a local, thread-safe copy of the data
-	// By copying the shared_ptrs, we ensure that even if the main thread
-	// modifies the original vectors, our pointers for this simulation step remain valid.
-	std::vector<std::shared_ptr<PhysicsObject>> localMovingObjects;
-	std::vector<std::shared_ptr<PhysicsObject>> localFixedObjects;
+	// Every pair touched when it was detected, and nothing has moved since
+	const int bodyA = pair.bodyA;
+	if (pair.bIsFixed)
 	{
-		std::shared_lock lock(_objectsMutex);
-		localMovingObjects = _movingObjects;
-		localFixedObjects = _fixedObjects;
-	} // The read lock is released immediately after copying.
+		if (!_bodies.isOwned(bodyA) || _bodies.isSleeping(bodyA)) return;
+	}
+	else
+	{
+		// Only a moving body wakes a sleeping one, a quiet neighbour just leans on it
+		if (_bodies.isSleeping(bodyA) && !isBodyQuiet(pair.bodyB)) wakeBody(bodyA);
+		if (_bodies.isSleeping(pair.bodyB) && !isBodyQuiet(bodyA)) wakeBody(pair.bodyB);
+	}
+	contact.touching = true;
+	contact.normal = pair.normal;
+	contact.penetration = pair.depth;
 
-	const size_t numMovingObjects = localMovingObjects.size();
-	//if (numMovingObjects == 0) return;
-	// Ensure all threads reach the barrier even if there are no objects.
-	// If any thread exits early without hitting all arrive_and_wait points,
-	// it will cause deadlocks for the others waiting at those points.
-	if (numMovingObjects == 0)
+	const DirectX::XMFLOAT3 positionB = pair.bIsFixed ? DirectX::XMFLOAT3{ 0.0f, 0.0f, 0.0f } : _bodies.getPosition(pair.bodyB);
+	const DirectX::XMFLOAT3 velocityB = pair.bIsFixed ? DirectX::XMFLOAT3{ 0.0f, 0.0f, 0.0f } : _bodies.getVelocity(pair.bodyB);
+	const DirectX::XMFLOAT3 positionA = _bodies.getPosition(bodyA);
+	const DirectX::XMFLOAT3 velocityA = _bodies.getVelocity(bodyA);
+	const DirectX::XMVECTOR vNorm = XMLoadFloat3(&contact.normal);
+	const DirectX::XMVECTOR vA = XMLoadFloat3(&velocityA);
+	const DirectX::XMVECTOR vB = XMLoadFloat3(&velocityB);
+	const DirectX::XMVECTOR vPoint = XMLoadFloat3(&pair.point);
+	XMStoreFloat3(&contact.leverA, vPoint - XMLoadFloat3(&positionA));
+	XMStoreFloat3(&contact.leverB, vPoint - XMLoadFloat3(&positionB));
+
+	// The position iterations track the penetration as the bodies move along the normal
+	contact.depthOffset = contact.penetration + XMVectorGetX(XMVector3Dot(XMLoadFloat3(&positionA) - XMLoadFloat3(&positionB), vNorm));
+
+	// Only an impact faster than BOUNCE_SPEED bounces, resting contacts just stop
+	const float approachSpeed = -XMVectorGetX(XMVector3Dot(vA - vB, vNorm)); // before any warm start
+	if (approachSpeed > BOUNCE_SPEED)
 	{
-		_syncBarrier->arrive_and_wait();
-		_syncBarrier->arrive_and_wait();
-		_syncBarrier->arrive_and_wait();
-		_syncBarrier->arrive_and_wait();
-		return; // No objects to process, exit early.
+		int matA = static_cast<int>(_bodies.material[bodyA]);
+		int matB = static_cast<int>(pair.bIsFixed ? _fixedBodies[pair.bodyB].material : _bodies.material[pair.bodyB]);
+
+		float restitution = _useTickSettings ? _tickSettings.elasticity : globals::elasticity.load();
+		if (restitution < 0.0f) {
+			// Use lookup table for restitution if not set globally
+			restitution = elasticityLookup[matA][matB];
+			if (!_useTickSettings) globals::elasticity.store(restitution); // Update global value for consistency
+		}
+		contact.targetSpeed = restitution * approachSpeed;
 	}
 
-	// Calculate the workload for this thread.
-	size_t objectsPerThread = (numMovingObjects + numThreads - 1) / numThreads;
-	size_t startIndex = threadIndex * objectsPerThread;
-	size_t endIndex = std::min(startIndex + objectsPerThread, numMovingObjects);
+	if (!_activeWarmStart) return;
+
+	// Start from what the contact needed last tick, the friction part turned into the current contact plane.
+	// Impulses grow with the step, so they are rescaled if the step has just changed.
+	bool flipped = false;
+	const ContactImpulse cached = _contactCache.find(getContactKey(pair, flipped));
+	DirectX::XMVECTOR tangentImpulse = DirectX::XMVectorSet(cached.tangentX, cached.tangentY, cached.tangentZ, 0.0f) * _warmStartScale;
+	if (flipped) tangentImpulse = -tangentImpulse;
+	tangentImpulse -= vNorm * XMVector3Dot(tangentImpulse, vNorm);
+
+	contact.impulse.normal = cached.normal * _warmStartScale;
+	contact.impulse.tangentX = XMVectorGetX(tangentImpulse);
+	contact.impulse.tangentY = XMVectorGetY(tangentImpulse);
+	contact.impulse.tangentZ = XMVectorGetZ(tangentImpulse);
+}
+
+void PhysicsManager::loadSolverBody(int body)
+{
+	SolverBody& solverBody = _solverBodies[body];
+	solverBody.velX = _bodies.velX[body]; solverBody.velY = _bodies.velY[body]; solverBody.velZ = _bodies.velZ[body];
+	solverBody.posX = _bodies.posX[body]; solverBody.posY = _bodies.posY[body]; solverBody.posZ = _bodies.posZ[body];
+
+	// A body that is still asleep holds still like a fixed one.
+	// Remote bodies take part with their mass, but only their owner changes them.
+	solverBody.inverseMass = _bodies.isSleeping(body) ? 0.0f : _bodies.inverseMass[body];
+	solverBody.appliedInverseMass = _bodies.isOwned(body) ? solverBody.inverseMass : 0.0f;
+}
+
+void PhysicsManager::storeSolverBody(int body)
+{
+	const SolverBody& solverBody = _solverBodies[body];
+	if (solverBody.appliedInverseMass <= 0.0f) return;
+
+	_bodies.velX[body] = solverBody.velX; _bodies.velY[body] = solverBody.velY; _bodies.velZ[body] = solverBody.velZ;
+	_bodies.posX[body] = solverBody.posX; _bodies.posY[body] = solverBody.posY; _bodies.posZ[body] = solverBody.posZ;
+}
+
+void PhysicsManager::applyImpulse(int body, float impulseX, float impulseY, float impulseZ, const DirectX::XMFLOAT3& lever)
+{
+	SolverBody& solverBody = _solverBodies[body];
+	if (solverBody.appliedInverseMass <= 0.0f) return;
+
+	solverBody.velX += impulseX * solverBody.appliedInverseMass;
+	solverBody.velY += impulseY * solverBody.appliedInverseMass;
+	solverBody.velZ += impulseZ * solverBody.appliedInverseMass;
+
+	// Torque from Friction, the tangential part of the impulse at the contact point
+	const float inverseInertia = _bodies.inverseInertia[body];
+	_bodies.angVelX[body] += (lever.y * impulseZ - lever.z * impulseY) * inverseInertia;
+	_bodies.angVelY[body] += (lever.z * impulseX - lever.x * impulseZ) * inverseInertia;
+	_bodies.angVelZ[body] += (lever.x * impulseY - lever.y * impulseX) * inverseInertia;
+}
+
+void PhysicsManager::warmStartPair(const CollisionPair& pair, const PairContact& contact)
+{
+	if (!contact.touching || contact.impulse.normal <= 0.0f) return;
+
+	const DirectX::XMFLOAT3& normal = contact.normal;
+	const float impulseX = normal.x * contact.impulse.normal + contact.impulse.tangentX;
+	const float impulseY = normal.y * contact.impulse.normal + contact.impulse.tangentY;
+	const float impulseZ = normal.z * contact.impulse.normal + contact.impulse.tangentZ;
+
+	applyImpulse(pair.bodyA, impulseX, impulseY, impulseZ, contact.leverA);
+	if (!pair.bIsFixed) applyImpulse(pair.bodyB, -impulseX, -impulseY, -impulseZ, contact.leverB);
+}
+
+void PhysicsManager::solveVelocity(const CollisionPair& pair, PairContact& contact)
+{
+	if (!contact.touching) return;
+
+	const int bodyA = pair.bodyA;
+	const int bodyB = pair.bodyB;
+	const SolverBody& solverBodyA = _solverBodies[bodyA];
+	const SolverBody fixedBody = {};
+	const SolverBody& solverBodyB = pair.bIsFixed ? fixedBody : _solverBodies[bodyB];
+
+	const float invMassSum = solverBodyA.inverseMass + solverBodyB.inverseMass;
+	if (invMassSum <= 1e-6f) return;
+
+	const DirectX::XMVECTOR vNorm = XMLoadFloat3(&contact.normal);
+	const DirectX::XMVECTOR vA = DirectX::XMVectorSet(solverBodyA.velX, solverBodyA.velY, solverBodyA.velZ, 0.0f);
+	const DirectX::XMVECTOR vB = DirectX::XMVectorSet(solverBodyB.velX, solverBodyB.velY, solverBodyB.velZ, 0.0f);
+
+	// Normal Impulse
+	// The total for the tick may take back part of the warm start, but never pulls the bodies together
+	const float velocityAlongNormal = XMVectorGetX(XMVector3Dot(vA - vB, vNorm));
+	const float normalImpulse = std::max(contact.impulse.normal + (contact.targetSpeed - velocityAlongNormal) / invMassSum, 0.0f);
+	const float deltaNormalImpulse = normalImpulse - contact.impulse.normal;
+
+	// Friction Impulse, static and dynamic friction
+	int matA = static_cast<int>(_bodies.material[bodyA]);
+	int matB = static_cast<int>(pair.bIsFixed ? _fixedBodies[bodyB].material : _bodies.material[bodyB]);
+
+	float staticFriction = _useTickSettings ? _tickSettings.staticFriction : globals::staticFriction.load();
+	if (staticFriction < 0.0f) {
+		staticFriction = staticFrictionLookup[matA][matB];
+		if (!_useTickSettings) globals::staticFriction.store(staticFriction); // Update global value for consistency
+	}
+	float dynamicFriction = _useTickSettings ? _tickSettings.dynamicFriction : globals::dynamicFriction.load();
+	if (dynamicFriction < 0.0f) {
+		dynamicFriction = dynamicFrictionLookup[matA][matB];
+		if (!_useTickSettings) globals::dynamicFriction.store(dynamicFriction); // Update global value for consistency
+	}
+
+	// Static friction holds while the total stays within staticFriction * normal impulse, past it the contact slides.
+	// The normal impulse does not change the tangential velocity, so both come from the same velocities.
+	const DirectX::XMVECTOR vRel = vA - vB;
+	const DirectX::XMVECTOR velTangent = vRel - vNorm * XMVector3Dot(vRel, vNorm);
+	const DirectX::XMVECTOR tangentImpulse = DirectX::XMVectorSet(contact.impulse.tangentX, contact.impulse.tangentY, contact.impulse.tangentZ, 0.0f);
+	DirectX::XMVECTOR newTangentImpulse = tangentImpulse - velTangent / invMassSum;
+
+	const float tangentImpulseLength = XMVectorGetX(XMVector3Length(newTangentImpulse));
+	if (tangentImpulseLength > staticFriction * normalImpulse)
+	{
+		newTangentImpulse = tangentImpulseLength > 1e-6f
+			? newTangentImpulse * (dynamicFriction * normalImpulse / tangentImpulseLength)
+			: DirectX::XMVectorZero();
+	}
+	const DirectX::XMVECTOR deltaTangentImpulse = newTangentImpulse - tangentImpulse;
+
+	contact.impulse.normal = normalImpulse;
+	contact.impulse.tangentX = XMVectorGetX(newTangentImpulse);
+	contact.impulse.tangentY = XMVectorGetY(newTangentImpulse);
+	contact.impulse.tangentZ = XMVectorGetZ(newTangentImpulse);
+
+	const DirectX::XMFLOAT3& normal = contact.normal;
+	const float impulseX = normal.x * deltaNormalImpulse + XMVectorGetX(deltaTangentImpulse);
+	const float impulseY = normal.y * deltaNormalImpulse + XMVectorGetY(deltaTangentImpulse);
+	const float impulseZ = normal.z * deltaNormalImpulse + XMVectorGetZ(deltaTangentImpulse);
+
+	applyImpulse(bodyA, impulseX, impulseY, impulseZ, contact.leverA);
+	if (!pair.bIsFixed) applyImpulse(bodyB, -impulseX, -impulseY, -impulseZ, contact.leverB);
+}
+
+void PhysicsManager::solvePosition(const CollisionPair& pair, const PairContact& contact)
+{
+	if (!contact.touching) return;
+
+	SolverBody& solverBodyA = _solverBodies[pair.bodyA];
+	SolverBody fixedBody = {};
+	SolverBody& solverBodyB = pair.bIsFixed ? fixedBody : _solverBodies[pair.bodyB];
+
+	const float invMassSum = solverBodyA.inverseMass + solverBodyB.inverseMass;
+	if (invMassSum <= 1e-6f) return;
+
+	// Positional Correction
+	const DirectX::XMFLOAT3& normal = contact.normal;
+	const float penetrationDepth = contact.depthOffset
+		- ((solverBodyA.posX - solverBodyB.posX) * normal.x + (solverBodyA.posY - solverBodyB.posY) * normal.y + (solverBodyA.posZ - solverBodyB.posZ) * normal.z);
+
+	const float percent = 0.4f; // Increased a bit for more stability
+	const float slop = 0.01f;
+	const float correctionMag = (std::max(penetrationDepth - slop, 0.0f) / invMassSum) * percent;
+	if (correctionMag <= 0.0f) return;
+
+	solverBodyA.posX += correctionMag * normal.x * solverBodyA.appliedInverseMass;
+	solverBodyA.posY += correctionMag * normal.y * solverBodyA.appliedInverseMass;
+	solverBodyA.posZ += correctionMag * normal.z * solverBodyA.appliedInverseMass;
+
+	solverBodyB.posX -= correctionMag * normal.x * solverBodyB.appliedInverseMass;
+	solverBodyB.posY -= correctionMag * normal.y * solverBodyB.appliedInverseMass;
+	solverBodyB.posZ -= correctionMag * normal.z * solverBodyB.appliedInverseMass;
+}
+
+void PhysicsManager::storeContact(const CollisionPair& pair, const PairContact& contact)
+{
+	if (contact.impulse.normal <= 0.0f) return; // apart, or only just touching
 
-	// Clear and Populate the Grid 
-	size_t totalCells = _grid.size();
-	size_t cellsPerThread = (totalCells + numThreads - 1) / numThreads;
-	size_t startCell = threadIndex * cellsPerThread;
-	size_t endCell = std::min(startCell + cellsPerThread, totalCells);
-	for (size_t i = startCell; i < endCell; ++i)
+	bool flipped = false;
+	const uint64_t key = getContactKey(pair, flipped);
+	ContactImpulse impulse = contact.impulse;
+	if (flipped)
 	{
-		_grid[i].clear();
+		impulse.tangentX = -impulse.tangentX;
+		impulse.tangentY = -impulse.tangentY;
+		impulse.tangentZ = -impulse.tangentZ;
 	}
-	_syncBarrier->arrive_and_wait();
+	_contactCache.store(key, impulse);
+}
+
+void PhysicsManager::storeContacts()
+{
+	// The pairs still index the body store of the tick that just ended
+	const std::vector<CollisionPair>& islandPairs = _contactIslands.getPairs();
+	const std::vector<CollisionPair>& colouredPairs = _contactColouring.getPairs();
+	if (_islandContacts.size() != islandPairs.size() || _colouredContacts.size() != colouredPairs.size()) return;
+
+	// The large islands' pairs were resolved in colour order
+	const size_t firstSmallPair = _contactIslands.getLargePairs().size();
+	_contactCache.beginStore(islandPairs.size() - firstSmallPair + colouredPairs.size());
 
-	for (size_t i = startIndex; i < endIndex; ++i)
+	for (size_t k = firstSmallPair; k < islandPairs.size(); ++k)
 	{
-		const auto& obj = localMovingObjects[i];
-		if (obj)
+		storeContact(islandPairs[k], _islandContacts[k]);
+	}
+	for (size_t k = 0; k < colouredPairs.size(); ++k)
+	{
+		storeContact(colouredPairs[k], _colouredContacts[k]);
+	}
+	_numCachedContacts.store(_contactCache.size());
+}
+
+void PhysicsManager::constrainBodyToBounds(int body)
+{
+	const float boxMin = -globals::AXIS_LENGTH;
+	const float boxMax = globals::AXIS_LENGTH;
+	const float radius = _bodies.radius[body];
+	const float bounceDamping = -0.4f;
+
+	// Only affect velocity if the body is moving towards the boundary.
+	// This prevents waking up sleeping objects.
+	auto constrainAxis = [&](float& pos, float& vel)
 		{
-			int gridIndex = getGridIndex(obj->getPosition());
-			if (gridIndex >= 0 && gridIndex < _grid.size())
-			{
-				std::lock_guard<std::mutex> cellLock(_gridMutexes[gridIndex]);
-				_grid[gridIndex].push_back(i);
+			if (pos - radius < boxMin && vel < 0) {
+				pos = boxMin + radius;
+				vel *= bounceDamping;
 			}
-		}
+			else if (pos + radius > boxMax && vel > 0) {
+				pos = boxMax - radius;
+				vel *= bounceDamping;
+			}
+		};
+
+	constrainAxis(_bodies.posX[body], _bodies.velX[body]);
+	constrainAxis(_bodies.posY[body], _bodies.velY[body]);
+	constrainAxis(_bodies.posZ[body], _bodies.velZ[body]);
+}
+
+void PhysicsManager::findGridPairs(int chunk, int numChunks, int startIndex, int endIndex, SpherePairBatch& batch) const
+{
+	// Detect Moving vs Moving
+	if (_activeGridStencil == GridStencil::HALF)
+	{
+		_grid.forEachCellPair(chunk, numChunks, [&](int a, int b) { if (canCollide(a, b)) batch.add(a, b); });
+		return;
+	}
+
+	for (int i = startIndex; i < endIndex; ++i)
+	{
+		_grid.forEachNeighbour(i, _bodies.posX[i], _bodies.posY[i], _bodies.posZ[i], [&](int j) { if (canCollide(i, j)) batch.add(i, j); });
+	}
+}
+
+void PhysicsManager::findHierarchicalGridPairs(int startIndex, int endIndex, SpherePairBatch& batch) const
+{
+	// Detect Moving vs Moving
+	for (int i = startIndex; i < endIndex; ++i)
+	{
+		_hierarchicalGrid.forEachNeighbour(i, _bodies, [&](int j) { if (canCollide(i, j)) batch.add(i, j); });
+	}
+}
+
+void PhysicsManager::findSpatialHashPairs(int startIndex, int endIndex, SpherePairBatch& batch) const
+{
+	// Detect Moving vs Moving
+	for (int i = startIndex; i < endIndex; ++i)
+	{
+		_spatialHash.forEachNeighbour(i, _bodies.posX[i], _bodies.posY[i], _bodies.posZ[i], [&](int j) { if (canCollide(i, j)) batch.add(i, j); });
 	}
-	_syncBarrier->arrive_and_wait();
+}
 
-	// Detect ALL Collisions
-	_threadCollisionPairs[threadIndex].clear();
+void PhysicsManager::findSweepAndPrunePairs(int chunk, int numChunks, SpherePairBatch& batch) const
+{
+	// Overlapping boxes are only candidates, each chunk confirms its share of them
+	const size_t numPairs = _sweepAndPrune.getPairCount();
+	const size_t pairsPerChunk = (numPairs + numChunks - 1) / numChunks;
+	const size_t startPair = std::min(chunk * pairsPerChunk, numPairs);
+	const size_t endPair = std::min(startPair + pairsPerChunk, numPairs);
 
-	for (size_t i = startIndex; i < endIndex; ++i)
+	for (size_t k = startPair; k < endPair; ++k)
 	{
-		PhysicsObject* objA = localMovingObjects[i].get();
-		if (!objA) continue;
+		int a, b;
+		_sweepAndPrune.getPair(k, a, b);
+		if (canCollide(a, b)) batch.add(a, b);
+	}
+}
 
- 		//DirectX::XMFLOAT3 posA = objA->getPosition();
-		DirectX::XMFLOAT3 posA = objA->isOwned() ? objA->getPosition() : objA->getSmoothedPosition(dt);
-		int centerCellX = static_cast<int>((posA.x - _worldMin.x) / _cellSize);
-		int centerCellY = static_cast<int>((posA.y - _worldMin.y) / _cellSize);
-		int centerCellZ = static_cast<int>((posA.z - _worldMin.z) / _cellSize);
+void PhysicsManager::getChunkRange(int chunk, int numChunks, int count, int& begin, int& end)
+{
+	const int perChunk = (count + numChunks - 1) / numChunks;
+	begin = std::min(chunk * perChunk, count);
+	end = std::min(begin + perChunk, count);
+}
 
-		// Detect Moving vs Moving
-		for (int z = -1; z <= 1; ++z) for (int y = -1; y <= 1; ++y) for (int x = -1; x <= 1; ++x)
-		{
-			int currentCellX = centerCellX + x, currentCellY = centerCellY + y, currentCellZ = centerCellZ + z;
-			if (currentCellX >= 0 && currentCellX < _gridCellsX && currentCellY >= 0 && currentCellY < _gridCellsY && currentCellZ >= 0 && currentCellZ < _gridCellsZ)
+void PhysicsManager::buildTickGraph()
+{
+	// The broadphase build is the only job with serial parts, so the fixed-collider tests and the
+	// island reset fill the other workers meanwhile. Small and large islands share no body.
+	_tickGraph.clear();
+	const int resetIslands = _tickGraph.add([this] { forEachBodyChunk([this](int, int begin, int end) { _contactIslands.resetBodies(begin, end); }); });
+	const int broadphase = _tickGraph.add([this] { buildBroadphase(); });
+	const int movingPairs = _tickGraph.add([this] { findMovingPairs(); }, { broadphase });
+	const int fixedPairs = _tickGraph.add([this] { findFixedPairs(); });
+	const int mergeMoving = _tickGraph.add([this] { mergePairs(0); }, { movingPairs });
+	const int mergeFixed = _tickGraph.add([this] { mergePairs(1); }, { fixedPairs });
+	const int islands = _tickGraph.add([this] { buildIslands(); }, { resetIslands, mergeMoving, mergeFixed });
+	const int smallIslands = _tickGraph.add([this] { solveSmallIslands(); }, { islands });
+	const int largeIslands = _tickGraph.add([this] { solveLargeIslands(); }, { islands });
+	const int integration = _tickGraph.add([this] { integrateBodies(); }, { smallIslands, largeIslands });
+	_tickGraph.add([this] { sweepFastBodies(); }, { integration });
+}
+
+void PhysicsManager::runTick()
+{
+	//if (globals::isPaused) return; // Skip simulation if paused
+
+	// The body store only changes between ticks (onTickComplete), so the count is stable for the whole graph
+	_numTickBodies = static_cast<int>(_bodies.size());
+	_tickGraph.run(_scheduler);
+	onTickComplete();
+}
+
+void PhysicsManager::buildBroadphase()
+{
+	const int numBodies = _numTickBodies;
+	const int numSlots = _numSlots;
+	auto forEachSlot = [&](auto&& fn)
+	{
+		_scheduler.parallelFor(0, numSlots, 1, [&](int first, int last)
 			{
-				int gridIndex = currentCellX + currentCellY * _gridCellsX + currentCellZ * _gridCellsX * _gridCellsY;
-				for (int j_idx : _grid[gridIndex])
+				for (int slot = first; slot < last; ++slot)
 				{
-					if (j_idx >= localMovingObjects.size()) continue;
+					int begin, end;
+					getChunkRange(slot, numSlots, numBodies, begin, end);
+					fn(slot, begin, end);
+				}
+			});
+	};
 
-					if (i < j_idx)
-					{
-						PhysicsObject* objB = localMovingObjects[j_idx].get();
-						if (!objB) continue;
+	if (_activeBroadphase == BroadphaseMethod::SWEEP_AND_PRUNE)
+	{
+		// The sort carries over from the last tick and is cheap to repair, but it is serial
+		_sweepAndPrune.update(_bodies);
+	}
+	else if (_activeBroadphase == BroadphaseMethod::HIERARCHICAL_GRID)
+	{
+		// Same passes as the uniform grid, over the cells of all levels
+		forEachSlot([&](int slot, int begin, int end) { _hierarchicalGrid.countBodies(_bodies, begin, end, slot); });
+		forEachSlot([&](int slot, int, int) { _hierarchicalGrid.sumCells(slot, numSlots); });
+		forEachSlot([&](int slot, int, int) { _hierarchicalGrid.assignOffsets(slot, numSlots); });
+		forEachSlot([&](int slot, int begin, int end) { _hierarchicalGrid.scatterBodies(_bodies, begin, end, slot); });
+	}
+	else if (_activeBroadphase == BroadphaseMethod::SPATIAL_HASH)
+	{
+		// Hashing the occupied cells is serial, the lookups afterwards are shared out
+		_spatialHash.build(_bodies);
+	}
+	else
+	{
+		// Populate the Grid: count, prefix sum, scatter. The histograms are per slot, not per chunk,
+		// as each one spans every cell; the passes are even work per body anyway.
+		forEachSlot([&](int slot, int begin, int end) { _grid.countBodies(_bodies, begin, end, slot); });
+		forEachSlot([&](int slot, int, int) { _grid.sumCells(slot, numSlots); });
+		forEachSlot([&](int slot, int, int) { _grid.assignOffsets(slot, numSlots); });
+		forEachSlot([&](int slot, int begin, int end) { _grid.scatterBodies(_bodies, begin, end, slot); });
+	}
+}
+
+void PhysicsManager::findMovingPairs()
+{
+	// The broadphases only hand out candidates, the sphere tests run in SIMD batches.
+	// Every chunk keeps its own contacts, so the pairs come out in the same order whoever runs it.
+	forEachBodyChunk([this](int chunk, int startIndex, int endIndex)
+		{
+			auto& sphereContacts = _chunkSphereContacts[chunk];
+			sphereContacts.clear();
+			SpherePairBatch batch(_narrowphase, _bodies, sphereContacts);
+
+			if (_activeBroadphase == BroadphaseMethod::SWEEP_AND_PRUNE) findSweepAndPrunePairs(chunk, _numChunks, batch);
+			else if (_activeBroadphase == BroadphaseMethod::HIERARCHICAL_GRID) findHierarchicalGridPairs(startIndex, endIndex, batch);
+			else if (_activeBroadphase == BroadphaseMethod::SPATIAL_HASH) findSpatialHashPairs(startIndex, endIndex, batch);
+			else findGridPairs(chunk, _numChunks, startIndex, endIndex, batch);
+			batch.flush();
+
+			auto& collisionPairs = _chunkCollisionPairs[chunk];
+			collisionPairs.clear();
+			for (const SphereContact& contact : sphereContacts)
+			{
+				const DirectX::XMFLOAT3 normal = { contact.normalX, contact.normalY, contact.normalZ };
+				collisionPairs.push_back({ contact.bodyA, contact.bodyB, false, normal, contact.depth, getContactPoint(contact.bodyA, normal, contact.depth) });
+			}
+		});
+}
+
+void PhysicsManager::findFixedPairs()
+{
+	// Detect Moving vs Fixed, into the second half of the chunk lists
+	const float fixedQueryMargin = 0.01f; // covers the EPSILON slack of the Sphere tests
+	forEachBodyChunk([&](int chunk, int startIndex, int endIndex)
+		{
+			auto& collisionPairs = _chunkCollisionPairs[_numChunks + chunk];
+			collisionPairs.clear();
+			for (int i = startIndex; i < endIndex; ++i)
+			{
+				// A sleeping body rests on whatever holds it up
+				if (_bodies.isSleeping(i)) continue;
 
+				auto testFixed = [&](int f)
+					{
 						DirectX::XMFLOAT3 normal;
 						float penetration = 0.0f;
-						if (objA->checkCollision(*objB, normal, penetration))
+						if (testFixedBody(i, _fixedBodies[f], normal, penetration))
 						{
-							_threadCollisionPairs[threadIndex].push_back({ objA, objB });
+							collisionPairs.push_back({ i, f, true, normal, penetration, getContactPoint(i, normal, penetration) });
 						}
+					};
+
+				for (int f : _unboundedFixedBodies)
+				{
+					testFixed(f);
+				}
+
+				const float extent = _bodies.radius[i] + fixedQueryMargin;
+				const DirectX::XMFLOAT3 bodyMin = { _bodies.posX[i] - extent, _bodies.posY[i] - extent, _bodies.posZ[i] - extent };
+				const DirectX::XMFLOAT3 bodyMax = { _bodies.posX[i] + extent, _bodies.posY[i] + extent, _bodies.posZ[i] + extent };
+				_fixedBVH.query(bodyMin, bodyMax, testFixed);
+			}
+		});
+}
+
+void PhysicsManager::mergePairs(int kind)
+{
+	// Where every chunk list starts in the merged one
+	const int firstList = kind * _numChunks;
+	std::vector<int>& listStart = _mergeListStart[kind];
+	listStart.resize(static_cast<size_t>(_numChunks) + 1);
+	listStart[0] = 0;
+	for (int chunk = 0; chunk < _numChunks; ++chunk)
+	{
+		listStart[chunk + 1] = listStart[chunk] + static_cast<int>(_chunkCollisionPairs[firstList + chunk].size());
+	}
+	const int numPairs = listStart[_numChunks];
+
+	// Moving pairs are turned so bodyA has the lower key, whichever chunk found them. The contact point
+	// is taken from bodyA again, so it does not depend on the side it was found from either.
+	RadixSort& pairSort = _pairSorts[kind];
+	pairSort.resize(numPairs);
+	_scheduler.parallelFor(0, _numChunks, 1, [&](int first, int last)
+		{
+			for (int chunk = first; chunk < last; ++chunk)
+			{
+				std::vector<CollisionPair>& pairs = _chunkCollisionPairs[firstList + chunk];
+				for (size_t k = 0; k < pairs.size(); ++k)
+				{
+					CollisionPair& pair = pairs[k];
+					uint32_t keyA = getBodySortKey(pair.bodyA);
+					uint32_t keyB = pair.bIsFixed ? static_cast<uint32_t>(pair.bodyB) : getBodySortKey(pair.bodyB);
+					if (!pair.bIsFixed && keyA > keyB)
+					{
+						std::swap(pair.bodyA, pair.bodyB);
+						std::swap(keyA, keyB);
+						pair.normal = { -pair.normal.x, -pair.normal.y, -pair.normal.z };
+						pair.point = getContactPoint(pair.bodyA, pair.normal, pair.depth);
 					}
+
+					const int source = listStart[chunk] + static_cast<int>(k);
+					pairSort.set(source, (static_cast<uint64_t>(keyA) << 32) | keyB, source);
 				}
 			}
-		}
+		});
+	pairSort.sort(_scheduler, _numSlots);
 
-		// Detect Moving vs Fixed
-		for (const auto& fixed_ptr : localFixedObjects)
+	std::vector<CollisionPair>& merged = _mergedPairs[kind];
+	merged.resize(numPairs);
+	_scheduler.parallelFor(0, numPairs, MERGE_GRAIN, [&](int first, int last)
 		{
-			PhysicsObject* objB = fixed_ptr.get();
-			if (!objB) continue;
-			DirectX::XMFLOAT3 normal;
-			float penetration = 0.0f;
-			if (objA->checkCollision(*objB, normal, penetration))
+			for (int i = first; i < last; ++i)
 			{
-				_threadCollisionPairs[threadIndex].push_back({ objA, objB });
+				const int source = pairSort.getValue(i);
+				const int chunk = static_cast<int>(std::upper_bound(listStart.begin(), listStart.end(), source) - listStart.begin()) - 1;
+				merged[i] = _chunkCollisionPairs[firstList + chunk][source - listStart[chunk]];
 			}
-		}
-	}
-	_syncBarrier->arrive_and_wait();
+		});
+}
+
+uint32_t PhysicsManager::getBodySortKey(int body) const
+{
+	// Object ids are the same on every peer; bodies without one go after them, in body store order
+	const int objectId = _bodies.objectId[body];
+	return objectId >= 0 ? static_cast<uint32_t>(objectId) : 0x80000000u | static_cast<uint32_t>(body);
+}
+
+void PhysicsManager::buildIslands()
+{
+	// Build the contact islands
+	const std::vector<CollisionPair>& movingPairs = _mergedPairs[0];
+	_scheduler.parallelFor(0, static_cast<int>(movingPairs.size()), MERGE_GRAIN, [&](int first, int last)
+		{
+			_contactIslands.unitePairs(std::span<const CollisionPair>(movingPairs.data() + first, movingPairs.data() + last));
+		});
+	forEachBodyChunk([this](int, int begin, int end) { _contactIslands.findRoots(begin, end); });
 
-	//  Resolve ALL Collisions 
-	if (threadIndex == 0)
+	// Islands too big for one thread are coloured and shared out, unless parallel resolve is off. Which
+	// islands those are may not depend on the thread count, as colouring changes the order of the contacts.
+	const int numWorkers = _scheduler.getNumWorkers();
+	const bool parallelResolve = _parallelResolve.load();
+	const size_t minLargePairs = parallelResolve ? MIN_LARGE_ISLAND_PAIRS : SIZE_MAX;
+	const size_t minParallelPairs = parallelResolve && numWorkers > 1
+		? MIN_PARALLEL_PAIRS_PER_THREAD * static_cast<size_t>(numWorkers)
+		: SIZE_MAX;
+	_contactIslands.build(_mergedPairs, _numTickBodies, minLargePairs, ISLAND_TASK_COST);
+	_contactColouring.build(_contactIslands.getLargePairs(), _numTickBodies, minParallelPairs);
+	_islandContacts.resize(_contactIslands.getPairs().size());
+	_colouredContacts.resize(_contactColouring.getPairs().size());
+}
+
+void PhysicsManager::solveSmallIslands()
+{
+	const std::vector<ContactIslands::Island>& islands = _contactIslands.getIslands();
+	const std::vector<int>& islandBodies = _contactIslands.getBodies();
+	const std::vector<CollisionPair>& islandPairs = _contactIslands.getPairs();
+
+	// Small islands: each task resolves a few whole islands, on whichever worker takes it.
+	// The contacts are solved in iterations over a packed copy of their bodies, written back before integration.
+	const int velocityIterations = _activeVelocityIterations;
+	const int positionIterations = _activePositionIterations;
+	_scheduler.parallelFor(0, _contactIslands.getNumTasks(), 1, [&](int firstTask, int lastTask)
+		{
+			for (int task = firstTask; task < lastTask; ++task)
+			{
+				for (int i = _contactIslands.getTaskStart(task); i < _contactIslands.getTaskEnd(task); ++i)
+				{
+					const ContactIslands::Island& island = islands[i];
+					const size_t firstPair = island.firstPair;
+					const size_t endPair = island.firstPair + island.numPairs;
+					for (size_t k = firstPair; k < endPair; ++k)
+					{
+						prepareContact(islandPairs[k], _islandContacts[k]);
+					}
+					for (int b = island.firstBody; b < island.firstBody + island.numBodies; ++b)
+					{
+						loadSolverBody(islandBodies[b]);
+					}
+					for (size_t k = firstPair; k < endPair; ++k)
+					{
+						warmStartPair(islandPairs[k], _islandContacts[k]);
+					}
+					for (int iteration = 0; iteration < velocityIterations; ++iteration)
+					{
+						for (size_t k = firstPair; k < endPair; ++k)
+						{
+							solveVelocity(islandPairs[k], _islandContacts[k]);
+						}
+					}
+					for (int iteration = 0; iteration < positionIterations; ++iteration)
+					{
+						for (size_t k = firstPair; k < endPair; ++k)
+						{
+							solvePosition(islandPairs[k], _islandContacts[k]);
+						}
+					}
+					for (int b = island.firstBody; b < island.firstBody + island.numBodies; ++b)
+					{
+						storeSolverBody(islandBodies[b]);
+					}
+				}
+			}
+		});
+}
+
+void PhysicsManager::solveLargeIslands()
+{
+	// Large islands: each colour holds every body at most once, so its pairs are split into
+	// chunks for the workers, and the small colours left at the end run on this worker alone.
+	// Every contact is found before any is warm-started, and warm-started before any is solved,
+	// so each step and each iteration is one pass over the colours.
+	const std::vector<int>& islandBodies = _contactIslands.getBodies();
+	const std::vector<CollisionPair>& colouredPairs = _contactColouring.getPairs();
+	const int numParallelColours = _contactColouring.getNumParallelColours();
+	const int minChunkPairs = static_cast<int>(MIN_PARALLEL_PAIRS_PER_THREAD / CHUNKS_PER_WORKER);
+	auto forEachColouredPair = [&](auto&& fn)
 	{
-		_allCollisionPairs.clear();
-		for (const auto& thread_list : _threadCollisionPairs)
+		for (int colour = 0; colour < numParallelColours; ++colour)
 		{
-			_allCollisionPairs.insert(_allCollisionPairs.end(), thread_list.begin(), thread_list.end());
+			const int colourStart = static_cast<int>(_contactColouring.getColourStart(colour));
+			const int colourEnd = static_cast<int>(_contactColouring.getColourEnd(colour));
+			const int grain = std::max(minChunkPairs, (colourEnd - colourStart + _numChunks - 1) / _numChunks);
+			_scheduler.parallelFor(colourStart, colourEnd, grain, [&](int first, int last)
+				{
+					for (int k = first; k < last; ++k) fn(static_cast<size_t>(k));
+				});
 		}
 
-		for (const auto& pair : _allCollisionPairs)
+		for (size_t k = _contactColouring.getSerialStart(); k < colouredPairs.size(); ++k)
 		{
-			DirectX::XMFLOAT3 normal;
-			float penetration = 0.0f;
+			fn(k);
+		}
+	};
+
+	const int numLargeBodies = _contactIslands.getLargeBodyCount();
+	const int largeBodyGrain = std::max(1, (numLargeBodies + _numChunks - 1) / _numChunks);
+	forEachColouredPair([&](size_t k) { prepareContact(colouredPairs[k], _colouredContacts[k]); });
+	_scheduler.parallelFor(0, numLargeBodies, largeBodyGrain, [&](int first, int last)
+		{
+			for (int b = first; b < last; ++b) loadSolverBody(islandBodies[b]);
+		});
+
+	forEachColouredPair([&](size_t k) { warmStartPair(colouredPairs[k], _colouredContacts[k]); });
+	for (int iteration = 0; iteration < _activeVelocityIterations; ++iteration)
+	{
+		forEachColouredPair([&](size_t k) { solveVelocity(colouredPairs[k], _colouredContacts[k]); });
+	}
+	for (int iteration = 0; iteration < _activePositionIterations; ++iteration)
+	{
+		forEachColouredPair([&](size_t k) { solvePosition(colouredPairs[k], _colouredContacts[k]); });
+	}
+
+	_scheduler.parallelFor(0, numLargeBodies, largeBodyGrain, [&](int first, int last)
+		{
+			for (int b = first; b < last; ++b) storeSolverBody(islandBodies[b]);
+		});
+}
 
-			if (pair.objA->checkCollision(*pair.objB, normal, penetration))
+void PhysicsManager::integrateBodies()
+{
+	// Update Physics State: every velocity is final, so each chunk of the store is integrated in one
+	// batch, then its bodies are published, except those that moved far enough to be swept first
+	auto& networkManager = NetworkManager::getInstance();
+	const IntegrationMethod method = _useTickSettings
+		? _tickSettings.integrationMethod
+		: static_cast<IntegrationMethod>(std::clamp(globals::integrationMethod.load(), 0, static_cast<int>(IntegrationMethod::VERLET)));
+	const float dt = _timeStep;
+	forEachBodyChunk([&](int chunk, int startIndex, int endIndex)
+		{
+			_integrator.integrate(_bodies, startIndex, endIndex, dt, _activeGravity, method);
+
+			std::vector<SweptBody>& sweptBodies = _chunkSweptBodies[chunk];
+			sweptBodies.clear();
+			for (int body = startIndex; body < endIndex; ++body)
 			{
-				//OutputDebugString(L"[DEBUG] COLLISION \n");
+				if (!stepBody(body, dt)) continue;
+				if (_activeContinuousCollision && needsSweep(body)) sweptBodies.push_back({ body, SweptSphere::NO_HIT, { 0.0f, 0.0f, 0.0f } });
+				else publishBody(body, networkManager);
+			}
+			if (!sweptBodies.empty()) _numSweptBodies.fetch_add(static_cast<int>(sweptBodies.size()));
+		});
+}
+
+void PhysicsManager::sweepFastBodies()
+{
+	// Continuous collision: every body has moved, so the sweeps read the start and end positions
+	// while nothing writes them, and the stops are applied after all sweeps are done.
+	if (_numSweptBodies.load() == 0) return;
 
-				if (pair.objA->isOwned())
-					pair.objA->resolveCollision(*pair.objB, normal, penetration);
+	auto& networkManager = NetworkManager::getInstance();
+	_sweepHash.build(_bodies);
 
-				if (pair.objB->isOwned())
+	_scheduler.parallelFor(0, _numChunks, 1, [this](int first, int last)
+		{
+			for (int chunk = first; chunk < last; ++chunk)
+			{
+				for (SweptBody& swept : _chunkSweptBodies[chunk])
 				{
-					// Invert the normal for symmetric resolution
-					DirectX::XMFLOAT3 inverseNormal = { -normal.x, -normal.y, -normal.z };
-					pair.objB->resolveCollision(*pair.objA, inverseNormal, penetration);
+					swept.timeOfImpact = sweepBody(swept.body, swept.normal);
 				}
 			}
-		}
-	}
-	_syncBarrier->arrive_and_wait();
+		});
+	_scheduler.parallelFor(0, _numChunks, 1, [&](int first, int last)
+		{
+			for (int chunk = first; chunk < last; ++chunk)
+			{
+				for (const SweptBody& swept : _chunkSweptBodies[chunk])
+				{
+					if (swept.timeOfImpact <= 1.0f) applySweep(swept);
+					publishBody(swept.body, networkManager);
+				}
+			}
+		});
+}
 
-	auto& networkManager = NetworkManager::getInstance();
-	int localPeerId = networkManager.getLocalPeerId();
+bool PhysicsManager::needsSweep(int body) const
+{
+	// The solver body still holds where integration started
+	const SolverBody& start = _solverBodies[body];
+	const float motionX = _bodies.posX[body] - start.posX;
+	const float motionY = _bodies.posY[body] - start.posY;
+	const float motionZ = _bodies.posZ[body] - start.posZ;
+	const float limit = SWEEP_MOTION_FRACTION * _bodies.radius[body];
+	return motionX * motionX + motionY * motionY + motionZ * motionZ > limit * limit;
+}
+
+float PhysicsManager::sweepFixedBodies(const DirectX::XMFLOAT3& start, const DirectX::XMFLOAT3& motion, float radius, DirectX::XMFLOAT3& outNormal) const
+{
+	const float distance = sqrtf(motion.x * motion.x + motion.y * motion.y + motion.z * motion.z);
+	if (distance <= 1e-6f) return SweptSphere::NO_HIT;
+	float timeOfImpact = SweptSphere::NO_HIT;
+
+	// Fixed colliders have no closed form for every shape, so the motion is sampled finely enough
+	// that the sphere cannot step over a thin one. A contact only stops the body if the motion goes
+	// into it by more than the discrete tests tolerate; sliding along a surface is left alone.
+	Sphere probe(start, { 0.0f, 0.0f, 0.0f }, { radius, radius, radius });
+	const float maxStep = SWEEP_STEP_FRACTION * radius / distance;
+	const float maxApproach = SWEEP_MOTION_FRACTION * radius;
+	auto sweepFixed = [&](int f)
+		{
+			const Collider* collider = _fixedBodies[f].collider;
+			if (!collider) return;
+
+			DirectX::XMFLOAT3 normal;
+			auto isTouching = [&](float time)
+				{
+					probe.setPosition({ start.x + motion.x * time, start.y + motion.y * time, start.z + motion.z * time });
+					float penetration = 0.0f;
+					if (!probe.isColliding(*collider, normal, penetration)) return false;
+					return normal.x * motion.x + normal.y * motion.y + normal.z * motion.z < -maxApproach;
+				};
+
+			const float t = SweptSphere::sweepSampled(maxStep, isTouching);
+			if (t < timeOfImpact)
+			{
+				isTouching(t); // the normal where the sweep stopped
+				timeOfImpact = t;
+				outNormal = normal;
+			}
+		};
 
-	// Update Physics State
-	for (size_t i = startIndex; i < endIndex; ++i)
+	for (int f : _unboundedFixedBodies)
 	{
-		if (const auto& obj = localMovingObjects[i])
+		sweepFixed(f);
+	}
+
+	const float extent = radius + 0.01f; // the EPSILON slack of the Sphere tests, as in the broadphase
+	const DirectX::XMFLOAT3 sweepMin = {
+		std::min(start.x, start.x + motion.x) - extent,
+		std::min(start.y, start.y + motion.y) - extent,
+		std::min(start.z, start.z + motion.z) - extent };
+	const DirectX::XMFLOAT3 sweepMax = {
+		std::max(start.x, start.x + motion.x) + extent,
+		std::max(start.y, start.y + motion.y) + extent,
+		std::max(start.z, start.z + motion.z) + extent };
+	_fixedBVH.query(sweepMin, sweepMax, sweepFixed);
+
+	return timeOfImpact;
+}
+
+float PhysicsManager::sweepBody(int body, DirectX::XMFLOAT3& outNormal) const
+{
+	const SolverBody& start = _solverBodies[body];
+	const DirectX::XMFLOAT3 startPosition = { start.posX, start.posY, start.posZ };
+	const DirectX::XMFLOAT3 motion = { _bodies.posX[body] - start.posX, _bodies.posY[body] - start.posY, _bodies.posZ[body] - start.posZ };
+	const float distance = sqrtf(motion.x * motion.x + motion.y * motion.y + motion.z * motion.z);
+	const float radius = _bodies.radius[body];
+	float timeOfImpact = sweepFixedBodies(startPosition, motion, radius, outNormal);
+
+	// Other bodies near the path, each along its own motion this tick
+	auto sweepOther = [&](int other)
 		{
-			/*obj->Update(dt);
-			obj->constrainToBounds();*/
-			if (obj->getPeerID() == localPeerId)
-			//if (!globals::isPaused.load() && obj->getPeerID() == localPeerId)
+			if (other == body) return;
+
+			const SolverBody& otherStart = _solverBodies[other];
+			const DirectX::XMFLOAT3 offset = { start.posX - otherStart.posX, start.posY - otherStart.posY, start.posZ - otherStart.posZ };
+			const DirectX::XMFLOAT3 relativeMotion = {
+				motion.x - (_bodies.posX[other] - otherStart.posX),
+				motion.y - (_bodies.posY[other] - otherStart.posY),
+				motion.z - (_bodies.posZ[other] - otherStart.posZ) };
+			const float t = SweptSphere::sweepSpheres(offset, relativeMotion, radius + _bodies.radius[other]);
+			if (t < timeOfImpact)
 			{
-				// We own this object, so we calculate its physics.
-				obj->Update(dt);
-				obj->constrainToBounds();
+				const DirectX::XMFLOAT3 contactOffset = { offset.x + relativeMotion.x * t, offset.y + relativeMotion.y * t, offset.z + relativeMotion.z * t };
+				const float length = sqrtf(contactOffset.x * contactOffset.x + contactOffset.y * contactOffset.y + contactOffset.z * contactOffset.z);
+				if (length <= 1e-6f) return;
 
-				// After updating, broadcast the new state to other peers.
-				networkManager.sendObjectUpdate(obj->getObjectId(), obj->getPosition(), obj->getRotation(), obj->getVelocity(), obj->getScale());
+				timeOfImpact = t;
+				outNormal = { contactOffset.x / length, contactOffset.y / length, contactOffset.z / length };
 			}
-		}
+		};
+
+	const int numSamples = 1 + static_cast<int>(distance / _sweepHash.getCellSize());
+	for (int sample = 0; sample <= numSamples; ++sample)
+	{
+		const float time = static_cast<float>(sample) / numSamples;
+		_sweepHash.forEachNeighbour(-1, startPosition.x + motion.x * time, startPosition.y + motion.y * time, startPosition.z + motion.z * time, sweepOther);
 	}
 
-	if (threadIndex == 0) {
-		auto now = std::chrono::high_resolution_clock::now();
-		float elapsedMs = std::chrono::duration<float, std::milli>(now - _lastSimTime).count();
+	return timeOfImpact;
+}
 
-		if (_lastSimTime.time_since_epoch().count() != 0 && elapsedMs > 0.0f) {
-			float actualHz = 1000.0f / elapsedMs;
-			globals::actualSimFrequencyHz.store(actualHz);
-		}
-		_lastSimTime = now;
+void PhysicsManager::applySweep(const SweptBody& swept)
+{
+	const int body = swept.body;
+	const SolverBody& start = _solverBodies[body];
+	const DirectX::XMFLOAT3& n = swept.normal;
+	const float t = swept.timeOfImpact;
+	const DirectX::XMFLOAT3 motion = { _bodies.posX[body] - start.posX, _bodies.posY[body] - start.posY, _bodies.posZ[body] - start.posZ };
+
+	// Up to the contact, then the rest of the motion without the part going into it
+	const DirectX::XMFLOAT3 contactPosition = { start.posX + motion.x * t, start.posY + motion.y * t, start.posZ + motion.z * t };
+	const float approach = std::min(motion.x * n.x + motion.y * n.y + motion.z * n.z, 0.0f);
+	const DirectX::XMFLOAT3 slide = {
+		(motion.x - n.x * approach) * (1.0f - t),
+		(motion.y - n.y * approach) * (1.0f - t),
+		(motion.z - n.z * approach) * (1.0f - t) };
+
+	// The slide may run into another fixed collider, where it stops
+	DirectX::XMFLOAT3 slideNormal;
+	const float slideTime = std::min(sweepFixedBodies(contactPosition, slide, _bodies.radius[body], slideNormal), 1.0f);
+	_bodies.posX[body] = contactPosition.x + slide.x * slideTime;
+	_bodies.posY[body] = contactPosition.y + slide.y * slideTime;
+	_bodies.posZ[body] = contactPosition.z + slide.z * slideTime;
+}
+
+bool PhysicsManager::stepBody(int body, float dt)
+{
+	// Remote bodies are moved by their owner's updates only, and the integrator skipped them as well
+	if (!_bodies.isOwned(body) || _bodies.isSleeping(body)) return false;
+
+	constrainBodyToBounds(body);
+
+	// A body that falls asleep here is published once more, with its velocity cleared
+	const float driftX = _bodies.posX[body] - _bodies.restX[body];
+	const float driftY = _bodies.posY[body] - _bodies.restY[body];
+	const float driftZ = _bodies.posZ[body] - _bodies.restZ[body];
+	if (!isBodyQuiet(body) || driftX * driftX + driftY * driftY + driftZ * driftZ > SLEEP_DRIFT * SLEEP_DRIFT)
+	{
+		_bodies.quietTime[body] = 0.0f;
+		_bodies.restX[body] = _bodies.posX[body]; _bodies.restY[body] = _bodies.posY[body]; _bodies.restZ[body] = _bodies.posZ[body];
+	}
+	else if ((_bodies.quietTime[body] += dt) >= _activeSleepDelay && _activeSleepDelay > 0.0f)
+	{
+		sleepBody(body);
 	}
+	return true;
 }
 
-void PhysicsManager::startThreads(int numThreads, float dt)
+void PhysicsManager::publishBody(int body, NetworkManager& networkManager)
 {
-	if (_running.load()) return;
+	if (!_sendUpdates) return;
 
-	// stopThreads();
+	// Broadcast the new state to other peers, the renderer gets it from the snapshot
+	const float r = _bodies.radius[body];
+	networkManager.sendObjectUpdate(_bodies.objectId[body], _bodies.getPosition(body), _bodies.getRotation(body), _bodies.getVelocity(body), { r, r, r });
+}
 
-	// Clean up inconsistent state from previous attempts
-	_threadCollisionPairs.resize(numThreads);
-	_threadMovingPairs.resize(numThreads);
-	_threadFixedPairs.resize(numThreads);
+void PhysicsManager::publishSnapshot()
+{
+	WorldSnapshot& snapshot = _snapshots.beginWrite();
+	const int numBodies = static_cast<int>(_bodies.size());
+	snapshot.bodies.resize(numBodies);
 
-	_allCollisionPairs.clear();
+	_scheduler.parallelFor(0, numBodies, SNAPSHOT_GRAIN, [&](int first, int last)
+		{
+			for (int body = first; body < last; ++body)
+			{
+				snapshot.bodies[body] = {
+					_bodies.objectId[body],
+					_bodies.getPosition(body),
+					_bodies.getRotation(body),
+					_bodies.radius[body],
+					_bodies.lightColour[body],
+					_bodies.darkColour[body]
+				};
+			}
+		});
+	_snapshots.publish();
+}
 
-	_threadCollisionPairs.resize(numThreads);
-	int maxNumObjects = 10000; // 10k is fixed
-	_allCollisionPairs.reserve(maxNumObjects * 5); // 10k is fixed
+void PhysicsManager::storeObjectStates()
+{
+	for (size_t body = 0; body < _bodies.size(); ++body)
+	{
+		_bodies.objects[body]->setSimulatedState(_bodies.getPosition(body), _bodies.getRotation(body), _bodies.getVelocity(body));
+	}
+}
 
-	_running = true;
-	_threads.reserve(numThreads);
+bool PhysicsManager::isBodyQuiet(int body) const
+{
+	// Spin only turns the rendered body, it never feeds back into the motion, so only the linear speed counts
+	const float speedSq = _bodies.velX[body] * _bodies.velX[body] + _bodies.velY[body] * _bodies.velY[body] + _bodies.velZ[body] * _bodies.velZ[body];
+	return speedSq < _quietSpeed * _quietSpeed;
+}
 
-	float worldExtent = globals::AXIS_LENGTH;
-	initGrid(0.5f, { -worldExtent, -worldExtent, -worldExtent }, { worldExtent, worldExtent, worldExtent });
+void PhysicsManager::sleepBody(int body)
+{
+	_bodies.velX[body] = 0.0f; _bodies.velY[body] = 0.0f; _bodies.velZ[body] = 0.0f;
+	_bodies.angVelX[body] = 0.0f; _bodies.angVelY[body] = 0.0f; _bodies.angVelZ[body] = 0.0f;
+	_bodies.flags[body] |= BODY_SLEEPING;
+	_numSleeping.fetch_add(1);
+}
 
-	if (numThreads > 0)
+void PhysicsManager::wakeBody(int body)
+{
+	_bodies.flags[body] &= ~BODY_SLEEPING;
+	_bodies.quietTime[body] = 0.0f;
+	_numSleeping.fetch_sub(1);
+}
+
+void PhysicsManager::wakeAllBodies()
+{
+	for (size_t i = 0; i < _bodies.size(); ++i)
 	{
-		_syncBarrier = std::make_unique<std::barrier<>>(numThreads);
+		_bodies.flags[i] &= ~BODY_SLEEPING;
+		_bodies.quietTime[i] = 0.0f;
 	}
+	_numSleeping.store(0);
+}
 
-	for (int i = 0; i < numThreads; ++i)
+void PhysicsManager::latchSleepSettings()
+{
+	// Sleeping bodies would not notice a change of gravity, and nothing wakes them once sleeping is off
+	const float gravity = getTickGravity();
+	const float sleepDelay = _sleepDelay.load();
+	if (gravity != _activeGravity || (sleepDelay <= 0.0f && _activeSleepDelay > 0.0f))
 	{
-		_threads.emplace_back([this, i, numThreads, dt]() {
-			const int coreIndex = 3 + i;
-			DWORD_PTR mask = 1ULL << coreIndex;
-			if (SetThreadAffinityMask(GetCurrentThread(), mask) == 0)
-			{
-				OutputDebugString(L"[WARNING] Failed to set thread affinity.\n");
-			}
+		wakeAllBodies();
+	}
+	_activeGravity = gravity;
+	_activeSleepDelay = sleepDelay;
 
-			while (_running)
-			{
-				if (globals::isPaused) continue;
+	// A body resting on something still picks up one tick of gravity before the contact cancels it
+	_quietSpeed = SLEEP_SPEED + std::abs(gravity) * _timeStep;
+}
+
+float PhysicsManager::getTickGravity() const
+{
+	return _useTickSettings ? _tickSettings.gravity : globals::gravityY.load() * globals::gravityEnabled.load();
+}
+
+void PhysicsManager::onTickComplete()
+{
+	// Every job of the tick is done with the body store
+	storeContacts();
+	applyPendingChanges();
+	reorderBodies();
+	_contactIslands.resize(_bodies.size());
+	_solverBodies.resize(_bodies.size());
+	publishSnapshot();
+	_continueTicking = _running.load();
+
+	// The clock first, the tick just done ran with the old step
+	auto now = std::chrono::high_resolution_clock::now();
+	float elapsedMs = std::chrono::duration<float, std::milli>(now - _lastSimTime).count();
+
+	if (_lastSimTime.time_since_epoch().count() != 0 && elapsedMs > 0.0f) {
+		float actualHz = 1000.0f / elapsedMs;
+		globals::actualSimFrequencyHz.store(actualHz);
+	}
+	_lastSimTime = now;
+	scheduleNextTick(now);
+	latchTimeStep();
+
+	BroadphaseMethod broadphase = _broadphaseMethod.load();
+	if (broadphase != _activeBroadphase)
+	{
+		// The sweep-and-prune state goes stale while another method is active
+		_sweepAndPrune.reset();
+		_activeBroadphase = broadphase;
+	}
+	_activeGridStencil = _gridStencil.load();
+	_activeWarmStart = _warmStart.load();
+	_activeVelocityIterations = _velocityIterations.load();
+	_activePositionIterations = _positionIterations.load();
+	_activeContinuousCollision = _continuousCollision.load();
+	_numSweptBodies.store(0);
+	latchSleepSettings();
+}
+
+void PhysicsManager::latchTimeStep()
+{
+	// The step follows the target frequency, from the GUI or from the host. A big change is spread
+	// over a few ticks so the warm-started contacts and the sleep thresholds follow it smoothly.
+	const float previousStep = _timeStep;
+	const float frequency = _useTickSettings ? 0.0f : globals::targetSimFrequencyHz.load(); // runTicks keeps its step
+	if (frequency > 0.0f)
+	{
+		const float targetStep = 1.0f / frequency;
+		_timeStep = std::clamp(targetStep, previousStep / MAX_STEP_CHANGE, previousStep * MAX_STEP_CHANGE);
+	}
+	_warmStartScale = _timeStep / previousStep;
+}
+
+void PhysicsManager::scheduleNextTick(std::chrono::high_resolution_clock::time_point now)
+{
+	const double step = _timeStep;
+
+	// The tick just done paid off one step of the wall time since the last one
+	_timeDebt += std::chrono::duration<double>(now - _lastScheduleTime).count() - step;
+	_lastScheduleTime = now;
+
+	// Further behind than the catch-up allows: give the rest up rather than chase it
+	const double maxDebt = _maxSubsteps.load() * step;
+	if (_timeDebt > maxDebt)
+	{
+		_droppedTime.store(_droppedTime.load() + static_cast<float>(_timeDebt - maxDebt));
+		_timeDebt = maxDebt;
+	}
+
+	// Ahead, wait until the step is due. Behind, start the next tick at once to catch up.
+	const std::chrono::duration<double> wait(std::max(-_timeDebt, 0.0));
+	_nextTickTime = now + std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(wait);
+
+	// Simulated time over wall time, measured over half a second so catch-up bursts average out
+	_factorSimulatedTime += step;
+	const double window = std::chrono::duration<double>(now - _factorWindowStart).count();
+	if (window >= 0.5)
+	{
+		globals::realTimeFactor.store(static_cast<float>(_factorSimulatedTime / window));
+		_factorWindowStart = now;
+		_factorSimulatedTime = 0.0;
+	}
+}
+
+void PhysicsManager::resumeClock(std::chrono::high_resolution_clock::time_point now)
+{
+	// The pause is neither owed nor dropped: ticks continue from now as if the pause never happened
+	_timeDebt = 0.0;
+	_lastScheduleTime = now;
+	_nextTickTime = now;
+	_lastSimTime = now;
+	_factorWindowStart = now;
+	_factorSimulatedTime = 0.0;
+}
+
+void PhysicsManager::setPaused(bool paused)
+{
+	{
+		std::lock_guard<std::mutex> lock(_runMutex);
+		globals::isPaused.store(paused);
+	}
+	_runCondition.notify_all();
+}
+
+void PhysicsManager::reorderBodies()
+{
+	const int interval = _reorderInterval.load();
+	if (interval <= 0 || ++_ticksSinceReorder < interval) return;
+	_ticksSinceReorder = 0;
+
+	if (_mortonOrder.measureDisorder(_bodies) <= _reorderThreshold.load()) return;
+
+	_mortonOrder.computeOrder(_bodies, _reorderScratch);
+	_bodies.reorder(_reorderScratch);
+
+	// The pair buffers are refilled every tick, but the sweep-and-prune keeps body indices across ticks
+	_sweepAndPrune.reset();
+}
+
+int PhysicsManager::getDefaultThreadCount()
+{
+	return CpuTopology::get().getDefaultWorkerCount();
+}
 
-				auto startTime = std::chrono::high_resolution_clock::now();
+void PhysicsManager::setThreadCount(int numThreads)
+{
+	numThreads = std::max(1, numThreads);
+	if (_threadCount.exchange(numThreads) == numThreads) return;
+	restartThreads();
+}
+
+void PhysicsManager::restartThreads()
+{
+	if (!_running.load()) return;
+
+	stopThreads();
+	startThreads(_threadCount.load(), _timeStep);
+}
+
+void PhysicsManager::pinWorker(int worker)
+{
+	// Workers go where the pinning policy puts them, after the render and network cores
+	if (!CpuTopology::get().pinCurrentThread(ThreadRole::SIMULATION, worker))
+	{
+		OutputDebugString(L"[WARNING] Failed to set thread affinity.\n");
+	}
+}
+
+void PhysicsManager::startThreads(int numThreads, float dt)
+{
+	if (_running.load()) return;
 
-				simulationLoop(i, numThreads, dt);
+	_sendUpdates = true;
+	_useTickSettings = false;
+	prepareThreads(numThreads, dt);
 
-				auto endTime = std::chrono::high_resolution_clock::now();
-				auto elapsedTime = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
-				auto targetTime = std::chrono::microseconds(static_cast<long long>(dt * 1'000'000));
+	_tickThread = std::thread([this]() {
+		pinWorker(0);
 
-				if (elapsedTime < targetTime)
+		while (_continueTicking)
+		{
+			if (globals::isPaused)
+			{
+				// Parked until setPaused(false) or stopThreads, the workers sleep in the scheduler meanwhile
 				{
-					// This is the single, correct wait.
-					// It waits for the remaining time OR until stopThreads notifies it.
 					std::unique_lock<std::mutex> lock(_runMutex);
-					_runCondition.wait_for(lock, targetTime - elapsedTime, [this] { return !_running; });
+					_runCondition.wait(lock, [this] { return !globals::isPaused.load() || !_running; });
 				}
+				if (!_running) break;
+
+				resumeClock(std::chrono::high_resolution_clock::now());
+				continue;
 			}
-			});
+
+			runTick();
+
+			// The tick's completion step scheduled the next one
+			if (std::chrono::high_resolution_clock::now() < _nextTickTime)
+			{
+				// Waits until the next tick is due OR until stopThreads notifies it.
+				std::unique_lock<std::mutex> lock(_runMutex);
+				_runCondition.wait_until(lock, _nextTickTime, [this] { return !_running; });
+			}
+		}
+		});
+}
+
+void PhysicsManager::runTicks(int numThreads, float dt, int numTicks, const TickSettings& settings)
+{
+	if (_running.load()) return;
+
+	_sendUpdates = false;
+	_useTickSettings = true;
+	_tickSettings = settings;
+	prepareThreads(numThreads, dt);
+	for (int tick = 0; tick < numTicks; ++tick)
+	{
+		runTick();
 	}
+	stopThreads();
+}
+
+uint64_t PhysicsManager::getStateHash() const
+{
+	// FNV-1a over the bits, so any difference at all shows
+	uint64_t hash = 0xCBF29CE484222325ull;
+	auto add = [&hash](const std::vector<float>& values)
+		{
+			for (float value : values)
+			{
+				uint32_t bits;
+				memcpy(&bits, &value, sizeof(bits));
+				for (int byte = 0; byte < 4; ++byte)
+				{
+					hash = (hash ^ ((bits >> (8 * byte)) & 0xFF)) * 0x100000001B3ull;
+				}
+			}
+		};
+	add(_bodies.posX); add(_bodies.posY); add(_bodies.posZ);
+	add(_bodies.velX); add(_bodies.velY); add(_bodies.velZ);
+	add(_bodies.angVelX); add(_bodies.angVelY); add(_bodies.angVelZ);
+	add(_bodies.rotX); add(_bodies.rotY); add(_bodies.rotZ);
+	return hash;
+}
+
+void PhysicsManager::prepareThreads(int numThreads, float dt)
+{
+	numThreads = std::max(1, numThreads);
+	_threadCount.store(numThreads);
+	_numSlots = numThreads;
+	_numChunks = numThreads > 1 ? numThreads * CHUNKS_PER_WORKER : 1;
+
+	// Clean up inconsistent state from previous attempts
+	_contactIslands.clear();
+	_contactColouring.clear();
+	_contactCache.clear();
+	_islandContacts.clear();
+	_colouredContacts.clear();
+
+	_chunkCollisionPairs.resize(2 * static_cast<size_t>(_numChunks));
+	_chunkSphereContacts.resize(_numChunks);
+	_chunkSweptBodies.resize(_numChunks);
+	_contactColouring.reserve(MAX_COLOURED_PAIRS);
+
+	_running = true;
+	_continueTicking = true;
+
+	_grid.init(0.5f, _worldMin, _worldMax, _numSlots);
+	_hierarchicalGrid.init(0.1f, _worldMin, _worldMax, _numSlots);
+	_spatialHash.init(0.5f);
+	_sweepHash.init(0.5f);
+	_mortonOrder.init(_worldMin, _worldMax);
+	_contactIslands.resize(_bodies.size());
+	_solverBodies.resize(_bodies.size());
+	_ticksSinceReorder = 0;
+	buildFixedBVH(); // the scenario has just placed its fixed objects
+	_sweepAndPrune.reset();
+	_activeBroadphase = _broadphaseMethod.load();
+	_activeGridStencil = _gridStencil.load();
+	_activeWarmStart = _warmStart.load();
+	_activeVelocityIterations = _velocityIterations.load();
+	_activePositionIterations = _positionIterations.load();
+	_activeContinuousCollision = _continuousCollision.load();
+	_numSweptBodies.store(0);
+	_timeStep = dt;
+	_warmStartScale = 1.0f;
+	_timeDebt = 0.0;
+	_lastScheduleTime = std::chrono::high_resolution_clock::now();
+	_nextTickTime = _lastScheduleTime;
+	_factorWindowStart = _lastScheduleTime;
+	_factorSimulatedTime = 0.0;
+	_droppedTime.store(0.0f);
+	_activeGravity = getTickGravity();
+	latchSleepSettings();
+	publishSnapshot(); // the scenario as loaded, until the first tick
+
+	_scheduler.start(numThreads, pinWorker);
+	buildTickGraph();
 }
 
 void PhysicsManager::stopThreads()
@@ -368,16 +1467,19 @@ void PhysicsManager::stopThreads()
 		std::lock_guard<std::mutex> lock(_runMutex);
 		_running = false; // Set running to false under a lock
 	}
-	_runCondition.notify_all(); // Notify all waiting threads that it's time to check the flag and exit
+	_runCondition.notify_all(); // Notify the tick thread that it's time to check the flag and exit
 
-	for (auto& thread : _threads)
+	if (_tickThread.joinable())
 	{
-		if (thread.joinable())
-		{
-			thread.join(); // This will now return promptly.
-		}
+		_tickThread.join(); // This will now return promptly, after the tick in progress.
 	}
-	_threads.clear();
+	_scheduler.stop();
+
+	// Hand over anything that arrived after the last tick so the body store stays complete,
+	// and leave the objects where the simulation stopped.
+	applyPendingChanges();
+	storeObjectStates();
+	publishSnapshot();
 }
 
 std::shared_ptr<PhysicsObject> PhysicsManager::getObjectById(int objectId)
@@ -395,5 +1497,12 @@ void PhysicsManager::updateObjectState(int objectId, const DirectX::XMFLOAT3& po
 	auto obj = getObjectById(objectId);
 	if (obj) {
 		obj->setNetworkState(position, rotation, velocity, scale);
+
+		// The simulation copy is refreshed at the next tick boundary
+		if (!obj->getFixed() && !globals::isPaused.load())
+		{
+			std::scoped_lock lock(_pendingMutex);
+			_pendingRemoteStates.push_back({ obj.get(), position, rotation, velocity });
+		}
 	}
 }
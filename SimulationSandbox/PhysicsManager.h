@@ -6,14 +6,73 @@
 #include <memory>
 #include <shared_mutex>
 #include <functional>
-#include <barrier>
 #include <utility>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <chrono>
 #include "PhysicsObject.h"
+#include "BodyStore.h"
+#include "UniformGrid.h"
+#include "HierarchicalGrid.h"
+#include "SpatialHash.h"
+#include "SweepAndPrune.h"
+#include "StaticBVH.h"
+#include "MortonOrder.h"
+#include "SphereNarrowphase.h"
+#include "ContactColouring.h"
+#include "ContactIslands.h"
+#include "ContactCache.h"
+#include "SweptSphere.h"
+#include "BodyIntegrator.h"
+#include "TaskScheduler.h"
+#include "CpuTopology.h"
+#include "WorldSnapshot.h"
+#include "RadixSort.h"
 
-struct CollisionPair
+class NetworkManager;
+
+// Broadphase used to find moving-vs-moving candidate pairs
+enum class BroadphaseMethod
+{
+	UNIFORM_GRID,
+	SWEEP_AND_PRUNE,
+	HIERARCHICAL_GRID, // for mixed body radii
+	SPATIAL_HASH       // no world bounds, memory follows the occupied cells
+};
+
+// Neighbour search of the uniform grid
+enum class GridStencil
 {
-	PhysicsObject* objA;
-	PhysicsObject* objB;
+	FULL, // every body scans all 27 cells around it and keeps the higher indices
+	HALF  // cell pairs: each cell with itself and its 13 forward neighbours
+};
+
+// What a tick otherwise reads from the globals, which the GUI and the network change at any time.
+// PhysicsManager::runTicks holds them fixed, so two runs of a scene compare like for like.
+struct TickSettings
+{
+	float gravity = -9.81f;
+	IntegrationMethod integrationMethod = IntegrationMethod::SEMI_IMPLICIT_EULER;
+	float elasticity = -1.0f;      // below 0, the material tables, as for the globals
+	float staticFriction = -1.0f;
+	float dynamicFriction = -1.0f;
+};
+
+// Fixed objects never move, so the simulation only needs their collider and material.
+struct FixedBody
+{
+	const Collider* collider;
+	Material material;
+};
+
+// A network update for a remote body, applied to the body store at the next tick boundary.
+struct RemoteBodyState
+{
+	PhysicsObject* object;
+	DirectX::XMFLOAT3 position;
+	DirectX::XMFLOAT3 rotation;
+	DirectX::XMFLOAT3 velocity;
 };
 
 class PhysicsManager
@@ -25,45 +84,273 @@ private:
 	std::vector<std::shared_ptr<PhysicsObject>> _movingObjects;
 	std::vector<std::shared_ptr<PhysicsObject>> _fixedObjects;
 
-	std::vector<std::vector<CollisionPair>> _threadCollisionPairs;
-	std::vector<CollisionPair> _allCollisionPairs;
+	// --- Simulation State ---
+	// Only touched by the simulation threads while they are running.
+	BodyStore _bodies;
+	std::vector<FixedBody> _fixedBodies;
+
+	// Fixed bodies with a bounding box go into the BVH, planes are tested against every body
+	StaticBVH _fixedBVH;
+	std::vector<int> _unboundedFixedBodies;
+	bool _fixedBVHDirty = false;
+
+	// Changes requested from other threads while the simulation is running,
+	// applied by the tick thread between ticks.
+	std::vector<PhysicsObject*> _pendingObjects;
+	std::vector<RemoteBodyState> _pendingRemoteStates;
+	std::mutex _pendingMutex;
+
+	std::vector<std::vector<CollisionPair>> _chunkCollisionPairs; // moving pairs per body chunk, then fixed pairs per body chunk
+
+	// The chunk lists depend on where the chunks start, so on the thread count. Each kind is merged
+	// into one list sorted by the object ids of its bodies, which resolving then follows, so a tick
+	// gives the same result on any number of threads and on every peer.
+	std::vector<std::vector<CollisionPair>> _mergedPairs{ 2 }; // moving, then fixed
+	std::vector<int> _mergeListStart[2]; // where each chunk list goes in the merged list, before sorting
+	RadixSort _pairSorts[2];
+	static constexpr int MERGE_GRAIN = 4096; // pairs per task
+	std::vector<std::vector<SphereContact>> _chunkSphereContacts;
+	SphereNarrowphase _narrowphase; // widest SIMD level the CPU supports
+	BodyIntegrator _integrator;     // same level
+
+	// Bodies connected by contacts form islands. Small islands are resolved as tasks by
+	// whichever worker is free; the contacts of large ones are grouped into colours that
+	// share no body and resolved in parallel.
+	ContactIslands _contactIslands;
+	ContactColouring _contactColouring;
+	std::atomic<bool> _parallelResolve{ true };
+	static constexpr size_t MIN_PARALLEL_PAIRS_PER_THREAD = 64; // smaller colours are left to one worker
+	static constexpr size_t MAX_COLOURED_PAIRS = 50000; // reserved up front, five contacts for each of 10k bodies
+	static constexpr size_t MIN_LARGE_ISLAND_PAIRS = 256; // coloured islands, the same on every thread count
+	static constexpr int ISLAND_TASK_COST = 256; // bodies plus pairs per task
+
+	// --- Contact Cache ---
+	// A touching pair starts the tick from last tick's impulse (warm start) and accumulates onto it.
+	// The totals are kept next to the pairs while resolving, then stored by object ids between ticks.
+	struct PairContact
+	{
+		DirectX::XMFLOAT3 normal = { 0.0f, 0.0f, 0.0f }; // towards bodyA
+		float penetration = 0.0f;
+		float depthOffset = 0.0f; // penetration = depthOffset - dot(positionA - positionB, normal)
+		DirectX::XMFLOAT3 leverA = { 0.0f, 0.0f, 0.0f }; // from the centre of each body to the contact point
+		DirectX::XMFLOAT3 leverB = { 0.0f, 0.0f, 0.0f };
+		float targetSpeed = 0.0f; // separating speed after the bounce
+		ContactImpulse impulse; // on bodyA
+		bool touching = false;
+	};
+	ContactCache _contactCache;
+	std::vector<PairContact> _islandContacts; // per ContactIslands pair
+	std::vector<PairContact> _colouredContacts; // per ContactColouring pair
+	std::atomic<size_t> _numCachedContacts{ 0 };
+	std::atomic<bool> _warmStart{ true };
+	bool _activeWarmStart = true;
+	static constexpr float BOUNCE_SPEED = 0.5f; // m/s, slower impacts do not bounce
+
+	// --- Contact Solver ---
+	// The contacts of an island are solved in '_velocityIterations' passes over their velocities, then
+	// '_positionIterations' passes pushing them apart, on a packed copy of what the passes read and
+	// write for each body. Per pass a contact only sees its neighbours' last results, so piles need
+	// several passes to carry their weight down; more passes converge further without a higher tick rate.
+	struct SolverBody
+	{
+		float velX = 0.0f, velY = 0.0f, velZ = 0.0f;
+		float inverseMass = 0.0f; // 0 while asleep
+		float posX = 0.0f, posY = 0.0f, posZ = 0.0f;
+		float appliedInverseMass = 0.0f; // 0 as well for remote bodies, which only their owner moves
+	};
+	std::vector<SolverBody> _solverBodies; // per body, valid for the bodies of the islands being solved
+	std::atomic<int> _velocityIterations{ 8 };
+	std::atomic<int> _positionIterations{ 3 };
+	int _activeVelocityIterations = 8;
+	int _activePositionIterations = 3;
+
+	// --- Continuous Collision ---
+	// A body that moved more than SWEEP_MOTION_FRACTION of its radius in a tick is swept from where
+	// the solver left it to where integration took it, against the fixed colliders and the other bodies.
+	// Where it first touches one, the rest of its motion slides along the contact plane, as far as the
+	// fixed colliders allow, and the next tick resolves the contact. Other bodies are found through a
+	// spatial hash of the end positions and swept along their own motion.
+	struct SweptBody
+	{
+		int body;
+		float timeOfImpact;
+		DirectX::XMFLOAT3 normal; // of the first contact, towards the body
+	};
+	static constexpr float SWEEP_MOTION_FRACTION = 0.5f;
+	static constexpr float SWEEP_STEP_FRACTION = 0.5f; // of the radius, between samples against fixed colliders
+	std::vector<std::vector<SweptBody>> _chunkSweptBodies;
+	std::atomic<int> _numSweptBodies{ 0 };
+	SpatialHash _sweepHash;
+	std::atomic<bool> _continuousCollision{ true };
+	bool _activeContinuousCollision = true;
+
+	// --- World Snapshot ---
+	// Copied from the body store at the end of every tick for the render thread, which never
+	// touches the PhysicsObjects or the body store while the simulation runs.
+	SnapshotBuffer _snapshots;
+	static constexpr int SNAPSHOT_GRAIN = 4096; // bodies per task
 
 	// for object lookup by ID
 	std::unordered_map<int, std::shared_ptr<PhysicsObject>> _objectIDMap;
 	mutable std::shared_mutex _mapMutex;
 
-	// --- Spatial Grid Members ---
-	std::vector<std::vector<int>> _grid;
-	std::vector<std::mutex> _gridMutexes;
-	int _gridCellsX = 0;
-	int _gridCellsY = 0;
-	int _gridCellsZ = 0;
-	float _cellSize = 0.0f;
+	// --- Broadphase ---
+	// The requested method is picked up at the next tick boundary, so every job
+	// of a tick works with the same one.
+	std::atomic<BroadphaseMethod> _broadphaseMethod{ BroadphaseMethod::UNIFORM_GRID };
+	BroadphaseMethod _activeBroadphase = BroadphaseMethod::UNIFORM_GRID;
+	UniformGrid _grid;
+	std::atomic<GridStencil> _gridStencil{ GridStencil::HALF };
+	GridStencil _activeGridStencil = GridStencil::HALF;
+	HierarchicalGrid _hierarchicalGrid;
+	SpatialHash _spatialHash;
+	SweepAndPrune _sweepAndPrune;
 	DirectX::XMFLOAT3 _worldMin;
 	DirectX::XMFLOAT3 _worldMax;
 
+	// --- Body Reordering ---
+	// Every '_reorderInterval' ticks the body store is checked and, when more disordered than
+	// '_reorderThreshold', sorted along a Z-order curve so neighbours are also close in memory.
+	MortonOrder _mortonOrder;
+	std::vector<int> _reorderScratch;
+	std::atomic<int> _reorderInterval{ 60 }; // 0 disables reordering
+	std::atomic<float> _reorderThreshold{ 0.1f };
+	int _ticksSinceReorder = 0;
+
+	// --- Sleeping ---
+	// A body that stayed below the sleep speed and within SLEEP_DRIFT of where it slowed down for
+	// '_sleepDelay' seconds falls asleep. It keeps its
+	// place in the broadphase, but is not integrated, tested against other sleeping or fixed bodies,
+	// or published, and holds still for the bodies resting on it, until a moving body touches it
+	// or gravity changes.
+	static constexpr float SLEEP_SPEED = 0.05f; // m/s on top of one tick of gravity
+	static constexpr float SLEEP_DRIFT = 0.01f; // m, a slow body that slides further is not at rest
+	std::atomic<float> _sleepDelay{ 0.5f }; // 0 disables sleeping
+	float _activeSleepDelay = 0.5f;
+	float _activeGravity = 0.0f;
+	float _quietSpeed = SLEEP_SPEED;
+	float _timeStep = 0.0f; // latched at the tick boundary, see latchTimeStep
+	std::atomic<int> _numSleeping{ 0 };
+
 	// --- Threading and Synchronization ---
+	// The tick thread runs one tick after another. A tick is a graph of jobs (_tickGraph) run on the
+	// workers of _scheduler, the tick thread being worker 0, and the jobs split bodies, cells, islands
+	// and colours into chunks that idle workers steal, so a slow chunk does not hold the rest up.
+	// Between ticks only the tick thread runs (onTickComplete).
 	mutable std::shared_mutex _objectsMutex;
-	std::vector<std::thread> _threads;
+	std::thread _tickThread;
+	TaskScheduler _scheduler;
+	TaskGraph _tickGraph;
+	static constexpr int CHUNKS_PER_WORKER = 4;
+	int _numChunks = 1;     // per body pass, each chunk with its own output lists
+	int _numSlots = 1;      // per grid build pass, one per worker as each has a histogram over all cells
+	int _numTickBodies = 0; // the body count, fixed for the whole tick
+	std::atomic<int> _threadCount{ getDefaultThreadCount() };
 	std::atomic<bool> _running{ false };
-	std::unique_ptr<std::barrier<>> _syncBarrier;
+	bool _continueTicking = false; // _running latched at the tick boundary
+	bool _sendUpdates = true;      // false for runTicks
+	bool _useTickSettings = false; // runTicks: _tickSettings and a fixed step instead of the globals
+	TickSettings _tickSettings;
 
-	//std::chrono::high_resolution_clock::time_point _lastSimTime;
+	std::chrono::high_resolution_clock::time_point _lastSimTime;
 
-	// For clean thread shutdown (transition between scenarios)
+	// --- Tick Scheduling ---
+	// Fixed steps against the wall clock. _timeDebt is the wall time not simulated yet: every tick
+	// pays off one step, and the threads only wait while it is negative. After an overrun the next
+	// ticks start at once until the debt is paid, but the debt is capped at _maxSubsteps steps and
+	// the rest is dropped, so a machine that cannot keep up runs slower than real time instead of
+	// falling further and further behind.
+	std::atomic<int> _maxSubsteps{ 4 }; // 0 never catches up
+	static constexpr float MAX_STEP_CHANGE = 1.25f; // per tick, either way
+	float _warmStartScale = 1.0f; // new step over the step the cached impulses were found with
+	double _timeDebt = 0.0;
+	std::chrono::high_resolution_clock::time_point _lastScheduleTime;
+	std::chrono::high_resolution_clock::time_point _nextTickTime; // the tick thread waits for it
+	std::chrono::high_resolution_clock::time_point _factorWindowStart;
+	double _factorSimulatedTime = 0.0;
+	std::atomic<float> _droppedTime{ 0.0f }; // seconds given up since the threads started
+
+	// For clean thread shutdown (transition between scenarios), and to wake the tick thread from a pause
 	std::mutex _runMutex;
 	std::condition_variable _runCondition;
 
-	// --- Collision Pair Storage ---
-	std::vector<std::vector<std::pair<int, int>>> _threadMovingPairs;
-	std::vector<std::vector<std::pair<int, int>>> _threadFixedPairs;
-	std::vector<std::pair<int, int>> _allMovingPairs;
-	std::vector<std::pair<int, int>> _allFixedPairs;
-
 	// --- Private Methods ---
-	void initGrid(float cellSize, const DirectX::XMFLOAT3& worldMin, const DirectX::XMFLOAT3& worldMax);
-	int getGridIndex(const DirectX::XMFLOAT3& position) const;
-	void simulationLoop(int threadIndex, int numThreads, float dt);
+	void prepareThreads(int numThreads, float dt); // everything up to the tick thread
+	static void pinWorker(int worker);
+	void buildTickGraph();
+	void runTick();
+	void onTickComplete();
+
+	void addToSimulation(PhysicsObject* obj);
+	void applyPendingChanges();
+	void buildFixedBVH();
+	void reorderBodies();
+	void scheduleNextTick(std::chrono::high_resolution_clock::time_point now);
+	void resumeClock(std::chrono::high_resolution_clock::time_point now);
+	void latchTimeStep();
+
+	// --- Tick Jobs ---
+	static void getChunkRange(int chunk, int numChunks, int count, int& begin, int& end);
+	// Calls fn(chunk, begin, end) for the '_numChunks' slices of the body store, in parallel
+	template <typename Fn>
+	void forEachBodyChunk(Fn&& fn)
+	{
+		_scheduler.parallelFor(0, _numChunks, 1, [&](int first, int last)
+			{
+				for (int chunk = first; chunk < last; ++chunk)
+				{
+					int begin, end;
+					getChunkRange(chunk, _numChunks, _numTickBodies, begin, end);
+					fn(chunk, begin, end);
+				}
+			});
+	}
+	void buildBroadphase();
+	void findMovingPairs();
+	void findFixedPairs();
+	void mergePairs(int kind); // 0 moving, 1 fixed
+	void buildIslands();
+	void solveSmallIslands();
+	void solveLargeIslands();
+	void integrateBodies();
+	void sweepFastBodies();
+
+	// --- Body Store Physics ---
+	void findGridPairs(int chunk, int numChunks, int startIndex, int endIndex, SpherePairBatch& batch) const;
+	void findHierarchicalGridPairs(int startIndex, int endIndex, SpherePairBatch& batch) const;
+	void findSpatialHashPairs(int startIndex, int endIndex, SpherePairBatch& batch) const;
+	void findSweepAndPrunePairs(int chunk, int numChunks, SpherePairBatch& batch) const;
+	bool testFixedBody(int body, const FixedBody& fixed, DirectX::XMFLOAT3& outNormal, float& penetrationDepth) const;
+	DirectX::XMFLOAT3 getContactPoint(int body, const DirectX::XMFLOAT3& normal, float depth) const;
+	void prepareContact(const CollisionPair& pair, PairContact& contact); // takes the detected contact and last tick's impulse
+	void loadSolverBody(int body);
+	void storeSolverBody(int body);
+	void applyImpulse(int body, float impulseX, float impulseY, float impulseZ, const DirectX::XMFLOAT3& lever);
+	void warmStartPair(const CollisionPair& pair, const PairContact& contact);
+	void solveVelocity(const CollisionPair& pair, PairContact& contact);
+	void solvePosition(const CollisionPair& pair, const PairContact& contact);
+	bool needsSweep(int body) const;
+	float sweepFixedBodies(const DirectX::XMFLOAT3& start, const DirectX::XMFLOAT3& motion, float radius, DirectX::XMFLOAT3& outNormal) const;
+	float sweepBody(int body, DirectX::XMFLOAT3& outNormal) const;
+	void applySweep(const SweptBody& swept);
+	uint64_t getContactKey(const CollisionPair& pair, bool& flipped) const;
+	uint32_t getBodySortKey(int body) const;
+	void storeContact(const CollisionPair& pair, const PairContact& contact);
+	void storeContacts();
+	bool stepBody(int body, float dt); // after integration, false when there is nothing to publish
+	void publishBody(int body, NetworkManager& networkManager);
+	void publishSnapshot();
+	void storeObjectStates(); // body store back into the PhysicsObjects, while the threads are stopped
+
+	// A pair is skipped when both bodies are asleep
+	bool canCollide(int bodyA, int bodyB) const { return ((_bodies.flags[bodyA] & _bodies.flags[bodyB]) & BODY_SLEEPING) == 0; }
+	bool isBodyQuiet(int body) const;
+	void sleepBody(int body);
+	void wakeBody(int body);
+	void wakeAllBodies();
+	void latchSleepSettings();
+	float getTickGravity() const;
+	void constrainBodyToBounds(int body);
 
 public:
 	PhysicsManager()
@@ -88,11 +375,59 @@ public:
 		std::span<const std::shared_ptr<PhysicsObject>>
 		)>& accessor) const;
 
+	// Render thread only: takes the newest snapshot, true if there was one since the last call
+	bool acquireSnapshot() { return _snapshots.acquire(); }
+	const WorldSnapshot& getSnapshot() const { return _snapshots.getRead(); }
+
 	void startThreads(int numThreads, float dt);
 	void stopThreads();
 
+	// Runs 'numTicks' ticks of 'dt' back to back on the calling thread and 'numThreads' - 1 workers,
+	// without waiting for the clock or sending network updates, and with 'settings' in place of the
+	// globals; for checks on an instance of their own
+	void runTicks(int numThreads, float dt, int numTicks, const TickSettings& settings = {});
+	// Hash of the bits of every body's state, while the threads are stopped
+	uint64_t getStateHash() const;
+
+	// Workers for the next start; changing it while running restarts the threads
+	static int getDefaultThreadCount();
+	void setThreadCount(int numThreads);
+	int getThreadCount() const { return _threadCount.load(); }
+	void restartThreads(); // picks up a new thread count or pinning policy
+
 	bool isRunning() const { return _running.load(); }
 
+	// Sets globals::isPaused; the tick thread sleeps while paused and wakes here
+	void setPaused(bool paused);
+
+	void setBroadphaseMethod(BroadphaseMethod method) { _broadphaseMethod.store(method); }
+	BroadphaseMethod getBroadphaseMethod() const { return _broadphaseMethod.load(); }
+	void setGridStencil(GridStencil stencil) { _gridStencil.store(stencil); }
+	GridStencil getGridStencil() const { return _gridStencil.load(); }
+	void setParallelResolve(bool parallel) { _parallelResolve.store(parallel); }
+	bool getParallelResolve() const { return _parallelResolve.load(); }
+	void setWarmStart(bool warmStart) { _warmStart.store(warmStart); }
+	bool getWarmStart() const { return _warmStart.load(); }
+	size_t getNumCachedContacts() const { return _numCachedContacts.load(); }
+	void setContinuousCollision(bool enabled) { _continuousCollision.store(enabled); }
+	bool getContinuousCollision() const { return _continuousCollision.load(); }
+	void setMaxSubsteps(int maxSubsteps) { _maxSubsteps.store(maxSubsteps); }
+	int getMaxSubsteps() const { return _maxSubsteps.load(); }
+	float getDroppedTime() const { return _droppedTime.load(); }
+	void setVelocityIterations(int iterations) { _velocityIterations.store(iterations); }
+	int getVelocityIterations() const { return _velocityIterations.load(); }
+	void setPositionIterations(int iterations) { _positionIterations.store(iterations); }
+	int getPositionIterations() const { return _positionIterations.load(); }
+
+	void setReorderInterval(int ticks) { _reorderInterval.store(ticks); }
+	int getReorderInterval() const { return _reorderInterval.load(); }
+	void setReorderThreshold(float disorder) { _reorderThreshold.store(disorder); }
+	float getReorderThreshold() const { return _reorderThreshold.load(); }
+
+	void setSleepDelay(float seconds) { _sleepDelay.store(seconds); }
+	float getSleepDelay() const { return _sleepDelay.load(); }
+	int getNumSleeping() const { return _numSleeping.load(); }
+
 	std::shared_ptr<PhysicsObject> getObjectById(int objectId);
 	void updateObjectState(int objectId, const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& rotation, const DirectX::XMFLOAT3& velocity, const DirectX::XMFLOAT3& scale);
 };
\ No newline at end of file
@@ -10,7 +10,8 @@ enum class IntegrationMethod
 {  
 SEMI_IMPLICIT_EULER,  
 RK4,
-MIDPOINT
+MIDPOINT,
+VERLET
 };  
 
 enum class Material
@@ -81,25 +82,17 @@ private:
 	float previousTimestamp;
 	float currentTimestamp;
 
+	// Initial physical properties. Once a moving object is added to the PhysicsManager
+	// its live state is kept in the BodyStore and this object only acts as a handle to it.
 	bool isFixed = false;  
 	DirectX::XMFLOAT3 velocity = { 0.0f, 0.0f, 0.0f };  
 	DirectX::XMFLOAT3 angularVelocity = { 0.0f, 0.0f, 0.0f };  
 	float inverseMomentOfInertia = 0.0f;
-	DirectX::XMFLOAT3 acceleration = { 0.0f, 0.0f, 0.0f };  
-	DirectX::XMFLOAT3 previousPosition = { 0.0f, 0.0f, 0.0f };
-	//DirectX::XMFLOAT3 gravitationalForce; // Gravity vector  
 	float mass = 1.0f;  
 	float inverseMass = 1.0f;   
 	Material material = Material::MAT1;
-	IntegrationMethod integrationMethod = IntegrationMethod::RK4;
 
-	// threading
-	mutable std::mutex collisionMutex;
-	mutable std::atomic_bool _positionRestored = false;
-
-	void moveSemiImplicitEuler(float dt);  
-	void moveRK4(float dt);  
-	void moveMidpoint(float dt);
+	int _bodyIndex = -1; // slot in the PhysicsManager body store, -1 for fixed or not yet added
 
 public: 
 	PhysicsObject(std::unique_ptr<Collider> col, bool fixed = false, float objMass = 1.0f, Material mat = Material::MAT1);
@@ -114,24 +107,17 @@ public:
 		_constantBuffer.World = _collider->updateWorldMatrix();
 	}*/
 
-	void Update(float dt);  
-
 	bool LoadModel(const std::string& filename)  
 	{  
 		return SJGLoader::Load(filename, _vertices, _indices);  
 	}  
 
-	void savePreviousPosition();
-
 	bool checkCollision(const PhysicsObject& other, DirectX::XMFLOAT3& outNormal, float& penetrationDepth) const
 	{  
 		if (!_collider || !other._collider) return false;
 
 		return _collider->isColliding(*other._collider, outNormal, penetrationDepth);
 	}  
-	void resolveCollision(PhysicsObject& other, const DirectX::XMFLOAT3& collisionNormal, float penetrationDepth);
-
-	void resetPositionRestorationFlag() const { _positionRestored = false; }
 
 	const Collider& getCollider() const { return *_collider; }  
 	Collider& getCollider() { return *_collider; }
@@ -141,24 +127,28 @@ public:
 	const DirectX::XMMATRIX& getTransformMatrix() const { return _constantBuffer.World; }  
 	const ConstantBuffer getConstantBuffer() const;
 	const float getMass() const { return mass; }  
+	float getInverseMass() const { return isFixed ? 0.0f : inverseMass; }
+	float getInverseMomentOfInertia() const { return inverseMomentOfInertia; }
+	Material getMaterial() const { return material; }
 	const DirectX::XMFLOAT3& getVelocity() const { return velocity; }
+	const DirectX::XMFLOAT3& getAngularVelocity() const { return angularVelocity; }
 	const DirectX::XMFLOAT3 getPosition() const;
 	const DirectX::XMFLOAT3 getScale() const { return _collider->getScale(); }
 	const DirectX::XMFLOAT3 getRotation() const;
 
-	void constrainToBounds();
-
 	const bool getFixed() const { return isFixed; }  
 	void setFixed(bool fixed) { isFixed = fixed; }  
 
 	void setVelocity(const DirectX::XMFLOAT3& newVel) { velocity = newVel; }  
 	void setAngularVelocity(const DirectX::XMFLOAT3& newAngVel) { angularVelocity = newAngVel; }  
 	void setConstantBuffer(const ConstantBuffer& cb) { _constantBuffer = cb; }  
-	void setIntegrationMethod(int method) { integrationMethod = static_cast<IntegrationMethod>(method); }  
 	void setMass(float newMass); // { mass = newMass; inverseMass = (mass != 0.0f) ? 1.0f / mass : 0.0f; }
 
-	// threading
-	std::mutex& getCollisionMutex() const { return collisionMutex; }
+	// body store handle
+	void setBodyIndex(int index) { _bodyIndex = index; }
+	int getBodyIndex() const { return _bodyIndex; }
+	// Publishes the simulated state of an owned body back to its collider and world matrix.
+	void setSimulatedState(const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& rotation, const DirectX::XMFLOAT3& newVelocity);
 
 	// networking
 	void setPeerID(int id) { _peerID = id; }
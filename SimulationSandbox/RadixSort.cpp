@@ -0,0 +1,104 @@
+#include "RadixSort.h"
+#include <algorithm>
+
+void RadixSort::getSlotRange(int slot, int numSlots, int count, int& begin, int& end)
+{
+	begin = static_cast<int>(static_cast<int64_t>(count) * slot / numSlots);
+	end = static_cast<int>(static_cast<int64_t>(count) * (slot + 1) / numSlots);
+}
+
+void RadixSort::resize(size_t count)
+{
+	_keys.resize(count);
+	_values.resize(count);
+}
+
+void RadixSort::sort(TaskScheduler& scheduler, int numSlots)
+{
+	const int count = static_cast<int>(_keys.size());
+	if (count <= 1) return;
+
+	numSlots = std::clamp(count / MIN_SLOT_ITEMS, 1, std::max(1, numSlots));
+	_scratchKeys.resize(count);
+	_scratchValues.resize(count);
+	_slotBuckets.resize(static_cast<size_t>(numSlots) * NUM_BUCKETS);
+	_slotBits.resize(static_cast<size_t>(numSlots) * 2);
+
+	auto forEachSlot = [&](auto&& fn)
+	{
+		scheduler.parallelFor(0, numSlots, 1, [&](int first, int last)
+			{
+				for (int slot = first; slot < last; ++slot)
+				{
+					int begin, end;
+					getSlotRange(slot, numSlots, count, begin, end);
+					fn(slot, begin, end);
+				}
+			});
+	};
+
+	// The bits that differ between any two keys
+	forEachSlot([&](int slot, int begin, int end)
+		{
+			uint64_t anyBits = 0, allBits = ~0ull;
+			for (int i = begin; i < end; ++i)
+			{
+				anyBits |= _keys[i];
+				allBits &= _keys[i];
+			}
+			_slotBits[2 * slot] = anyBits;
+			_slotBits[2 * slot + 1] = allBits;
+		});
+	uint64_t anyBits = 0, allBits = ~0ull;
+	for (int slot = 0; slot < numSlots; ++slot)
+	{
+		anyBits |= _slotBits[2 * slot];
+		allBits &= _slotBits[2 * slot + 1];
+	}
+	const uint64_t varyingBits = anyBits ^ allBits;
+
+	for (int digit = 0; digit < NUM_DIGITS; ++digit)
+	{
+		const int shift = digit * DIGIT_BITS;
+		if (((varyingBits >> shift) & (NUM_BUCKETS - 1)) == 0) continue;
+
+		// Pass 1: per-slot histogram of the digit
+		forEachSlot([&](int slot, int begin, int end)
+			{
+				int* buckets = _slotBuckets.data() + static_cast<size_t>(slot) * NUM_BUCKETS;
+				std::fill(buckets, buckets + NUM_BUCKETS, 0);
+				for (int i = begin; i < end; ++i)
+				{
+					++buckets[(_keys[i] >> shift) & (NUM_BUCKETS - 1)];
+				}
+			});
+
+		// Pass 2: bucket by bucket, the slots in order, which keeps equal digits in input order
+		int offset = 0;
+		for (int bucket = 0; bucket < NUM_BUCKETS; ++bucket)
+		{
+			for (int slot = 0; slot < numSlots; ++slot)
+			{
+				int& entry = _slotBuckets[static_cast<size_t>(slot) * NUM_BUCKETS + bucket];
+				const int bucketCount = entry;
+				entry = offset;
+				offset += bucketCount;
+			}
+		}
+
+		// Pass 3: every slot writes its items from its own cursors
+		forEachSlot([&](int slot, int begin, int end)
+			{
+				int* cursor = _slotBuckets.data() + static_cast<size_t>(slot) * NUM_BUCKETS;
+				for (int i = begin; i < end; ++i)
+				{
+					const int target = cursor[(_keys[i] >> shift) & (NUM_BUCKETS - 1)]++;
+					_scratchKeys[target] = _keys[i];
+					_scratchValues[target] = _values[i];
+				}
+			});
+
+		_keys.swap(_scratchKeys);
+		_values.swap(_scratchValues);
+	}
+}
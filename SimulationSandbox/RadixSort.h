@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "TaskScheduler.h"
+
+// Parallel LSD radix sort of 64-bit keys, each carrying an int, 8 bits per pass.
+// Every pass is split into slots that run in parallel, like CellSort:
+//   count -> assign offsets (one thread) -> scatter
+// and is stable, so the result only depends on the keys and their input order, never on the
+// number of slots. Digits that are the same in every key are skipped, so keys that only use
+// their low bytes cost a pass per byte used.
+class RadixSort
+{
+private:
+	static constexpr int DIGIT_BITS = 8;
+	static constexpr int NUM_BUCKETS = 1 << DIGIT_BITS;
+	static constexpr int NUM_DIGITS = 64 / DIGIT_BITS;
+	static constexpr int MIN_SLOT_ITEMS = 1024; // fewer items per slot are not worth a task
+
+	std::vector<uint64_t> _keys, _scratchKeys;
+	std::vector<int> _values, _scratchValues;
+	std::vector<int> _slotBuckets;   // NUM_BUCKETS per slot: the counts, then the write cursors
+	std::vector<uint64_t> _slotBits; // OR, then AND of each slot's keys
+
+	static void getSlotRange(int slot, int numSlots, int count, int& begin, int& end);
+
+public:
+	// Items [0, count) are then set by set(), from any thread, before sort()
+	void resize(size_t count);
+	void set(size_t i, uint64_t key, int value) { _keys[i] = key; _values[i] = value; }
+
+	// Sorts by key, equal keys keep their order. Runs on the scheduler, split into up to 'numSlots' slots.
+	void sort(TaskScheduler& scheduler, int numSlots);
+
+	size_t size() const { return _keys.size(); }
+	uint64_t getKey(size_t i) const { return _keys[i]; }
+	int getValue(size_t i) const { return _values[i]; }
+};
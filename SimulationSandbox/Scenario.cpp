@@ -3,6 +3,7 @@
 #include "Sphere.h"
 #include "Plane.h"
 #include "ShaderManager.h"
+#include "PhysicsBenchmark.h"
 #include <imgui_impl_dx11.h>
 #include <imgui_impl_win32.h>
 #include <random>
@@ -129,62 +130,25 @@ void Scenario::updateInstanceBuffer(float dt)
 		return; // No need to update if paused or resources are not ready.
 	}
 
-	instanceData.clear();
-	// We can reserve based on the total number of moving spheres we intend to have.
-	// This avoids multiple reallocations as spheres are spawned.
-	instanceData.reserve(numMovingSpheres);
-
-	float renderTime = dt;
-	//float renderTime = static_cast<float>(GetTickCount64()) / 1000.0f;
-
-	// The new access function gives us both lists.
-	// We only need the 'movingObjects' list here.
-	PhysicsManager::getInstance().accessAllObjects([&](
-		std::span<const std::shared_ptr<PhysicsObject>> movingObjects,
-		[[maybe_unused]] std::span<const std::shared_ptr<PhysicsObject>> fixedObjects)
-		{
-			// Now we loop directly over the list of moving objects.
-			// No need for 'if (!obj->getFixed())' check anymore!
-			for (const auto& obj : movingObjects)
-			{
-				if (obj)
-				{
-					InstanceData data;
-
-					if (!obj->isOwned())
-					{
-						DirectX::XMFLOAT3 smoothedPos = obj->getSmoothedPosition(renderTime);
-
-						Collider* collider = obj->getColliderPtr(); 
-						if (collider)
-						{
-							collider->setPosition(smoothedPos);
-							data.World = DirectX::XMMatrixTranspose(collider->updateWorldMatrix());
-						}
-						else
-						{
-							// Fallback: use a simple translation matrix
-							data.World = DirectX::XMMatrixTranslation(smoothedPos.x, smoothedPos.y, smoothedPos.z);
-						}
-					}
-					else
-					{
-						data.World = DirectX::XMMatrixTranspose(obj->getTransformMatrix());
-					}
-
-					const ConstantBuffer& cb = obj->getConstantBuffer();
-					data.LightColour = cb.LightColour;
-					data.DarkColour = cb.DarkColour;
+	// The newest snapshot of the simulation, the instance buffer still holds the last one otherwise.
+	// Remote bodies are drawn where their owner's latest update put them in the body store.
+	auto& physicsManager = PhysicsManager::getInstance();
+	if (!physicsManager.acquireSnapshot()) return;
+	const WorldSnapshot& snapshot = physicsManager.getSnapshot();
 
-					instanceData.push_back(data);
-				}
-			}
-		});
+	instanceData.resize(snapshot.bodies.size());
+	for (size_t i = 0; i < snapshot.bodies.size(); ++i)
+	{
+		const BodySnapshot& body = snapshot.bodies[i];
+		InstanceData& data = instanceData[i];
+		data.World = DirectX::XMMatrixTranspose(body.getWorldMatrix());
+		data.LightColour = body.lightColour;
+		data.DarkColour = body.darkColour;
+	}
 
 	numInstances = static_cast<UINT>(instanceData.size());
 	if (numInstances == 0) return;
 
-	// The rest of the function (Map, memcpy, Unmap) remains the same.
 	D3D11_MAPPED_SUBRESOURCE mappedResource;
 	HRESULT hr = context->Map(instanceBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
 	if (SUCCEEDED(hr))
@@ -280,11 +244,13 @@ HRESULT Scenario::initRenderingResources(PhysicsObject* obj)
 	indexBuffers.push_back(ib);
 	indexCounts.push_back(static_cast<UINT>(indices.size()));
 
-	// Create Constant Buffer for this specific object
+	// Create Constant Buffer for this specific object, fixed objects never move so it is filled once
 	bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
 	bd.ByteWidth = sizeof(ConstantBuffer);
+	const ConstantBuffer constantData = obj->getConstantBuffer();
+	initData.pSysMem = &constantData;
 	CComPtr<ID3D11Buffer> cb;
-	hr = device->CreateBuffer(&bd, nullptr, &cb);
+	hr = device->CreateBuffer(&bd, &initData, &cb);
 	if (FAILED(hr)) return hr;
 	constantBuffers.push_back(cb);
 
@@ -404,60 +370,43 @@ void Scenario::renderObjects()
 
 	context->PSSetShader(pixelShader, nullptr, 0);
 
-	auto& physicsManager = PhysicsManager::getInstance();
+	// --- Render FIXED objects (Non-Instanced) ---
+	// Everything they need was uploaded by initRenderingResources, the objects themselves are not read.
+	if (vertexShader_NonInstanced && !vertexBuffers.empty())
+	{
+		context->VSSetShader(vertexShader_NonInstanced, nullptr, 0);
 
-	// Use the new access function to get both lists separately.
-	physicsManager.accessAllObjects([&](
-		std::span<const std::shared_ptr<PhysicsObject>> movingObjects,
-		std::span<const std::shared_ptr<PhysicsObject>> fixedObjects)
+		for (size_t i = 0; i < vertexBuffers.size(); ++i)
 		{
-			// --- Render FIXED objects (Non-Instanced) ---
-			if (vertexShader_NonInstanced && !fixedObjects.empty())
-			{
-				context->VSSetShader(vertexShader_NonInstanced, nullptr, 0);
+			context->IASetInputLayout(inputLayouts[i]);
+			UINT stride = sizeof(Vertex);
+			UINT offset = 0;
+			context->IASetVertexBuffers(0, 1, &vertexBuffers[i].p, &stride, &offset);
+			context->IASetIndexBuffer(indexBuffers[i], DXGI_FORMAT_R32_UINT, 0);
 
-				// Loop directly over the fixed objects list.
-				// The rendering resources (vertexBuffers, etc.) are stored in parallel.
-				for (size_t i = 0; i < fixedObjects.size(); ++i)
-				{
-					const auto& obj = fixedObjects[i];
-					if (!obj) continue;
-					if (i >= vertexBuffers.size()) continue; // Safety check
-
-					context->IASetInputLayout(inputLayouts[i]);
-					UINT stride = sizeof(Vertex);
-					UINT offset = 0;
-					context->IASetVertexBuffers(0, 1, &vertexBuffers[i].p, &stride, &offset);
-					context->IASetIndexBuffer(indexBuffers[i], DXGI_FORMAT_R32_UINT, 0);
-
-					ConstantBuffer cb = obj->getConstantBuffer();
-					context->UpdateSubresource(constantBuffers[i], 0, nullptr, &cb, 0, 0);
-					context->VSSetConstantBuffers(1, 1, &constantBuffers[i].p);
-					context->PSSetConstantBuffers(1, 1, &constantBuffers[i].p);
-
-					context->DrawIndexed(indexCounts[i], 0, 0);
-				}
-			}
+			context->VSSetConstantBuffers(1, 1, &constantBuffers[i].p);
+			context->PSSetConstantBuffers(1, 1, &constantBuffers[i].p);
 
-			// --- Render MOVING spheres (Instanced) ---
-			// 'numInstances' is already calculated by updateInstanceBuffer.
-			// 'movingObjects' list is not directly used here, but this ensures
-			// we don't try to render if there are no moving objects.
-			if (vertexShader && numInstances > 0 && instanceBuffer && !movingObjects.empty())
-			{
-				context->VSSetShader(vertexShader, nullptr, 0);
+			context->DrawIndexed(indexCounts[i], 0, 0);
+		}
+	}
+
+	// --- Render MOVING spheres (Instanced) ---
+	// 'numInstances' is already calculated by updateInstanceBuffer from the latest snapshot.
+	if (vertexShader && numInstances > 0 && instanceBuffer)
+	{
+		context->VSSetShader(vertexShader, nullptr, 0);
 
-				ID3D11Buffer* instancedBuffers[] = { _sphereVertexBufferInstanced, instanceBuffer };
-				UINT strides[] = { sizeof(Vertex), sizeof(InstanceData) };
-				UINT offsets[] = { 0, 0 };
+		ID3D11Buffer* instancedBuffers[] = { _sphereVertexBufferInstanced, instanceBuffer };
+		UINT strides[] = { sizeof(Vertex), sizeof(InstanceData) };
+		UINT offsets[] = { 0, 0 };
 
-				context->IASetInputLayout(_inputLayoutInstanced);
-				context->IASetVertexBuffers(0, 2, instancedBuffers, strides, offsets);
-				context->IASetIndexBuffer(_sphereIndexBufferInstanced, DXGI_FORMAT_R32_UINT, 0);
+		context->IASetInputLayout(_inputLayoutInstanced);
+		context->IASetVertexBuffers(0, 2, instancedBuffers, strides, offsets);
+		context->IASetIndexBuffer(_sphereIndexBufferInstanced, DXGI_FORMAT_R32_UINT, 0);
 
-				context->DrawIndexedInstanced(_sphereIndexCountInstanced, numInstances, 0, 0, 0);
-			}
-		});
+		context->DrawIndexedInstanced(_sphereIndexCountInstanced, numInstances, 0, 0, 0);
+	}
 }
 
 void Scenario::onFrameUpdate(float dt)
@@ -524,6 +473,165 @@ void Scenario::applySharedGUI()
 			{
 				globals::integrationMethod = 2;
 			}
+			// Menu item for Velocity Verlet
+			if (ImGui::MenuItem("Velocity Verlet", nullptr, currentMethod == 3))
+			{
+				globals::integrationMethod = 3;
+			}
+
+			ImGui::EndMenu();
+		}
+
+		// Local setting, each peer picks its own broadphase
+		if (ImGui::BeginMenu("Broadphase"))
+		{
+			auto& physicsManager = PhysicsManager::getInstance();
+			BroadphaseMethod currentBroadphase = physicsManager.getBroadphaseMethod();
+
+			if (ImGui::MenuItem("Uniform Grid", nullptr, currentBroadphase == BroadphaseMethod::UNIFORM_GRID))
+			{
+				physicsManager.setBroadphaseMethod(BroadphaseMethod::UNIFORM_GRID);
+			}
+			if (ImGui::MenuItem("Sweep and Prune", nullptr, currentBroadphase == BroadphaseMethod::SWEEP_AND_PRUNE))
+			{
+				physicsManager.setBroadphaseMethod(BroadphaseMethod::SWEEP_AND_PRUNE);
+			}
+			if (ImGui::MenuItem("Hierarchical Grid", nullptr, currentBroadphase == BroadphaseMethod::HIERARCHICAL_GRID))
+			{
+				physicsManager.setBroadphaseMethod(BroadphaseMethod::HIERARCHICAL_GRID);
+			}
+			if (ImGui::MenuItem("Spatial Hash", nullptr, currentBroadphase == BroadphaseMethod::SPATIAL_HASH))
+			{
+				physicsManager.setBroadphaseMethod(BroadphaseMethod::SPATIAL_HASH);
+			}
+
+			ImGui::Separator();
+			bool halfStencil = physicsManager.getGridStencil() == GridStencil::HALF;
+			if (ImGui::Checkbox("Grid: half stencil (13 cells)", &halfStencil))
+			{
+				physicsManager.setGridStencil(halfStencil ? GridStencil::HALF : GridStencil::FULL);
+			}
+
+			bool parallelResolve = physicsManager.getParallelResolve();
+			if (ImGui::Checkbox("Resolve: parallel colours", &parallelResolve))
+			{
+				physicsManager.setParallelResolve(parallelResolve);
+			}
+
+			// Contacts start from last tick's impulses, which keeps stacks from sinking and jittering
+			bool warmStart = physicsManager.getWarmStart();
+			if (ImGui::Checkbox("Resolve: warm start contacts", &warmStart))
+			{
+				physicsManager.setWarmStart(warmStart);
+			}
+
+			// Fast bodies are swept along their motion, so small spheres do not pass through thin colliders
+			bool continuousCollision = physicsManager.getContinuousCollision();
+			if (ImGui::Checkbox("Continuous collision", &continuousCollision))
+			{
+				physicsManager.setContinuousCollision(continuousCollision);
+			}
+
+			// Passes over the contacts per tick, more settle piles further at the same tick rate
+			int velocityIterations = physicsManager.getVelocityIterations();
+			if (ImGui::SliderInt("Velocity iterations", &velocityIterations, 1, 16))
+			{
+				physicsManager.setVelocityIterations(velocityIterations);
+			}
+			int positionIterations = physicsManager.getPositionIterations();
+			if (ImGui::SliderInt("Position iterations", &positionIterations, 0, 8))
+			{
+				physicsManager.setPositionIterations(positionIterations);
+			}
+
+			// Workers sharing every tick; the simulation threads restart with the new count
+			ImGui::Separator();
+			const CpuTopology& topology = CpuTopology::get();
+			ImGui::Text("CPU: %d cores, %d logical, %d NUMA nodes", topology.getNumPhysicalCores(), topology.getNumLogical(), topology.getNumNodes());
+			int threadCount = physicsManager.getThreadCount();
+			if (ImGui::SliderInt("Simulation threads", &threadCount, 1, topology.getNumLogical()))
+			{
+				physicsManager.setThreadCount(threadCount);
+			}
+
+			// Render and network keep the first two cores, the workers are placed after them
+			const char* pinningPolicies[] = { "None", "Physical cores", "Logical processors" };
+			int pinningPolicy = static_cast<int>(CpuTopology::getPolicy());
+			if (ImGui::Combo("Thread pinning", &pinningPolicy, pinningPolicies, IM_ARRAYSIZE(pinningPolicies)))
+			{
+				CpuTopology::setPolicy(static_cast<PinningPolicy>(pinningPolicy));
+				physicsManager.restartThreads();
+
+				// The GUI runs on the render thread, the network thread moves on its next pass
+				CpuTopology::get().pinCurrentThread(ThreadRole::RENDER, 0);
+				NetworkManager::getInstance().requestRepin();
+			}
+
+			// Bodies at rest this long stop being simulated until something moving touches them
+			ImGui::Separator();
+			float sleepDelay = physicsManager.getSleepDelay();
+			if (ImGui::SliderFloat("Sleep after (s), 0 = never", &sleepDelay, 0.0f, 5.0f, "%.1f"))
+			{
+				physicsManager.setSleepDelay(sleepDelay);
+			}
+
+			// Sorting the body store along a Z-order curve keeps neighbours close in memory
+			ImGui::Separator();
+			int reorderInterval = physicsManager.getReorderInterval();
+			if (ImGui::SliderInt("Reorder every (ticks)", &reorderInterval, 0, 600))
+			{
+				physicsManager.setReorderInterval(reorderInterval);
+			}
+			float reorderThreshold = physicsManager.getReorderThreshold();
+			if (ImGui::SliderFloat("Reorder above disorder", &reorderThreshold, 0.0f, 0.5f, "%.2f"))
+			{
+				physicsManager.setReorderThreshold(reorderThreshold);
+			}
+
+			ImGui::EndMenu();
+		}
+
+		// Results go to the debug output
+		if (ImGui::BeginMenu("Benchmark"))
+		{
+			bool canRun = !PhysicsBenchmark::isRunning();
+
+			if (ImGui::MenuItem("Broadphase", nullptr, false, canRun))
+			{
+				PhysicsBenchmark::runAsync(PhysicsBenchmark::runBroadphase);
+			}
+			if (ImGui::MenuItem("Large Worlds", nullptr, false, canRun))
+			{
+				PhysicsBenchmark::runAsync(PhysicsBenchmark::runLargeWorld);
+			}
+			if (ImGui::MenuItem("Morton Reorder", nullptr, false, canRun))
+			{
+				PhysicsBenchmark::runAsync(PhysicsBenchmark::runReorder);
+			}
+			if (ImGui::MenuItem("Grid Stencil", nullptr, false, canRun))
+			{
+				PhysicsBenchmark::runAsync(PhysicsBenchmark::runStencil);
+			}
+			if (ImGui::MenuItem("Sphere Narrowphase", nullptr, false, canRun))
+			{
+				PhysicsBenchmark::runAsync(PhysicsBenchmark::runNarrowphase);
+			}
+			if (ImGui::MenuItem("Collision Dispatch", nullptr, false, canRun))
+			{
+				PhysicsBenchmark::runAsync(PhysicsBenchmark::runDispatch);
+			}
+			if (ImGui::MenuItem("Contact Colouring", nullptr, false, canRun))
+			{
+				PhysicsBenchmark::runAsync(PhysicsBenchmark::runContactColouring);
+			}
+			if (ImGui::MenuItem("Task Scheduler", nullptr, false, canRun))
+			{
+				PhysicsBenchmark::runAsync(PhysicsBenchmark::runTaskScheduler);
+			}
+			if (ImGui::MenuItem("Determinism", nullptr, false, canRun))
+			{
+				PhysicsBenchmark::runAsync(PhysicsBenchmark::runDeterminism);
+			}
 
 			ImGui::EndMenu();
 		}
@@ -577,10 +685,20 @@ void Scenario::applySharedGUI()
 					globals::targetGfxFrequencyHz.store(gfxFreq);
 				}
 
+				// Ticks run back to back after an overrun, up to this many steps behind the wall clock
+				int maxSubsteps = PhysicsManager::getInstance().getMaxSubsteps();
+				if (ImGui::SliderInt("Max catch-up steps", &maxSubsteps, 0, 8))
+				{
+					PhysicsManager::getInstance().setMaxSubsteps(maxSubsteps);
+				}
+
 				ImGui::Text("Actual GFX: %.1f Hz", globals::actualGfxFrequencyHz.load());
 				ImGui::Text("Actual Sim: %.1f Hz", globals::actualSimFrequencyHz.load());
+				ImGui::Text("Real-time factor: %.2f (dropped %.1f s)", globals::realTimeFactor.load(), PhysicsManager::getInstance().getDroppedTime());
 				ImGui::Text("Actual Net: %.1f Hz", globals::actualNetFrequencyHz.load());
 				ImGui::Text("Num. moving objects: %d", numMovingSpheres);
+				ImGui::Text("Num. sleeping objects: %d", PhysicsManager::getInstance().getNumSleeping());
+				ImGui::Text("Num. cached contacts: %zu", PhysicsManager::getInstance().getNumCachedContacts());
 
 				ImGui::EndTable();
 			}
@@ -629,7 +747,7 @@ void Scenario::applySharedGUI()
 		if (ImGui::Button(buttonLabel))
 		{
 			// If clicked, toggle the boolean state
-			globals::isPaused.store(!isPaused);
+			PhysicsManager::getInstance().setPaused(!isPaused);
 			stateChanged = true;
 		}
 
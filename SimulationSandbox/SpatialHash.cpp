@@ -0,0 +1,76 @@
+#include "SpatialHash.h"
+
+void SpatialHash::init(float cellSize)
+{
+	_cellSize = cellSize;
+	_inverseCellSize = 1.0f / cellSize;
+	clear();
+}
+
+void SpatialHash::clear()
+{
+	_slotKeys.clear();
+	_slotCells.clear();
+	_occupiedSlots.clear();
+	_bodyCells.clear();
+	_slotMask = 0;
+	_slotShift = 64;
+	_sort.init(0, 1);
+}
+
+void SpatialHash::reserveSlots(size_t numBodies)
+{
+	size_t capacity = MIN_CAPACITY;
+	while (capacity < numBodies * 2) capacity *= 2;
+
+	// Keep the table unless it is too small, or far too big after bodies were removed
+	if (capacity <= _slotKeys.size() && capacity * 8 > _slotKeys.size())
+	{
+		for (int slot : _occupiedSlots)
+		{
+			_slotKeys[slot] = EMPTY_KEY;
+		}
+		_occupiedSlots.clear();
+		return;
+	}
+
+	_slotKeys.assign(capacity, EMPTY_KEY);
+	_slotCells.assign(capacity, -1);
+	_occupiedSlots.clear();
+	_slotMask = static_cast<int>(capacity) - 1;
+
+	int bits = 0;
+	while ((size_t(1) << bits) < capacity) ++bits;
+	_slotShift = 64 - bits;
+}
+
+int SpatialHash::insertCell(uint64_t key)
+{
+	for (int slot = getSlot(key); ; slot = (slot + 1) & _slotMask)
+	{
+		if (_slotKeys[slot] == key) return _slotCells[slot];
+		if (_slotKeys[slot] == EMPTY_KEY)
+		{
+			// Fewer cells than bodies and the table holds twice the bodies, so a free slot always exists
+			_slotKeys[slot] = key;
+			_slotCells[slot] = static_cast<int>(_occupiedSlots.size());
+			_occupiedSlots.push_back(slot);
+			return _slotCells[slot];
+		}
+	}
+}
+
+void SpatialHash::build(const BodyStore& bodies)
+{
+	const size_t numBodies = bodies.size();
+	reserveSlots(numBodies);
+
+	_bodyCells.resize(numBodies);
+	for (size_t i = 0; i < numBodies; ++i)
+	{
+		_bodyCells[i] = insertCell(makeKey(getCellCoord(bodies.posX[i]), getCellCoord(bodies.posY[i]), getCellCoord(bodies.posZ[i])));
+	}
+
+	_sort.init(_occupiedSlots.size(), 1);
+	_sort.build(numBodies, [&](int i) { return _bodyCells[i]; });
+}
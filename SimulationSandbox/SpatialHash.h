@@ -0,0 +1,95 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include "BodyStore.h"
+#include "CellSort.h"
+
+// Uniform grid without world bounds: only occupied cells exist.
+// Cell coordinates are hashed into an open-addressing table (linear probing) that maps each
+// occupied cell to a dense cell id, then the bodies are counting-sorted by that id. Memory and
+// the per-tick clear scale with the number of bodies and occupied cells, not with the world size.
+// The build is serial (one thread, like the sweep-and-prune update); queries are read-only.
+class SpatialHash
+{
+private:
+	static constexpr uint64_t EMPTY_KEY = ~0ull;
+	static constexpr int COORD_BITS = 21; // per axis, cells -2^20 .. 2^20-1
+	static constexpr int MIN_CAPACITY = 1024;
+
+	float _cellSize = 0.5f;
+	float _inverseCellSize = 2.0f;
+
+	// Open-addressing table, capacity is a power of two at least twice the body count
+	std::vector<uint64_t> _slotKeys;
+	std::vector<int> _slotCells; // dense cell id of the slot
+	std::vector<int> _occupiedSlots; // cleared before the next build
+	int _slotMask = 0;
+	int _slotShift = 64;
+
+	std::vector<int> _bodyCells; // dense cell id per body
+	CellSort _sort;
+
+	int getCellCoord(float value) const
+	{
+		const float limit = static_cast<float>(1 << (COORD_BITS - 1)) - 1.0f;
+		return static_cast<int>(std::clamp(floorf(value * _inverseCellSize), -limit, limit));
+	}
+	static uint64_t makeKey(int cellX, int cellY, int cellZ)
+	{
+		const uint64_t bias = 1ull << (COORD_BITS - 1);
+		const uint64_t mask = (1ull << COORD_BITS) - 1;
+		return ((cellX + bias) & mask) | (((cellY + bias) & mask) << COORD_BITS) | (((cellZ + bias) & mask) << (2 * COORD_BITS));
+	}
+	int getSlot(uint64_t key) const
+	{
+		return static_cast<int>((key * 0x9E3779B97F4A7C15ull) >> _slotShift); // Fibonacci hashing
+	}
+
+	void reserveSlots(size_t numBodies);
+	int insertCell(uint64_t key);
+
+	// Dense id of the cell, -1 if no body is in it
+	int findCell(int cellX, int cellY, int cellZ) const
+	{
+		const uint64_t key = makeKey(cellX, cellY, cellZ);
+		for (int slot = getSlot(key); ; slot = (slot + 1) & _slotMask)
+		{
+			if (_slotKeys[slot] == key) return _slotCells[slot];
+			if (_slotKeys[slot] == EMPTY_KEY) return -1;
+		}
+	}
+
+public:
+	void init(float cellSize);
+	void clear();
+
+	// Rebuilds the table and the sorted body lists from the current positions
+	void build(const BodyStore& bodies);
+
+	// Calls fn(j) for every body j > i in the 3x3x3 cells around (x, y, z)
+	template <typename Fn>
+	void forEachNeighbour(int i, float x, float y, float z, Fn&& fn) const
+	{
+		if (_occupiedSlots.empty()) return;
+
+		const int centerCellX = getCellCoord(x), centerCellY = getCellCoord(y), centerCellZ = getCellCoord(z);
+		for (int dz = -1; dz <= 1; ++dz) for (int dy = -1; dy <= 1; ++dy) for (int dx = -1; dx <= 1; ++dx)
+		{
+			const int cell = findCell(centerCellX + dx, centerCellY + dy, centerCellZ + dz);
+			if (cell < 0) continue;
+
+			const int* cellBodies = _sort.getCellItems(cell);
+			const int cellCount = _sort.getCellCount(cell);
+			for (int k = 0; k < cellCount; ++k)
+			{
+				if (i < cellBodies[k]) fn(cellBodies[k]);
+			}
+		}
+	}
+
+	size_t getOccupiedCells() const { return _occupiedSlots.size(); }
+	size_t getCapacity() const { return _slotKeys.size(); }
+	float getCellSize() const { return _cellSize; }
+};
@@ -9,29 +9,12 @@
 
 using namespace DirectX;
 
-bool Sphere::isColliding(const Collider& other, DirectX::XMFLOAT3& outNormal, float& penetrationDepth) const
+bool Sphere::getBounds(DirectX::XMFLOAT3& outMin, DirectX::XMFLOAT3& outMax) const
 {
-    // Check if it's a Sphere
-    if (const Sphere* sphere = dynamic_cast<const Sphere*>(&other))
-        return isCollidingWithSphere(*sphere, outNormal, penetrationDepth);
-
-    // Check if it's a Plane
-    if (const Plane* plane = dynamic_cast<const Plane*>(&other))
-        return isCollidingWithPlane(*plane, outNormal, penetrationDepth);
-
-    // Check if it's a Cylinder
-    if (const Cylinder* cylinder = dynamic_cast<const Cylinder*>(&other))
-        return isCollidingWithCylinder(*cylinder, outNormal, penetrationDepth);
-
-    // Check if it's a Cube
-    if (const Cube* cube = dynamic_cast<const Cube*>(&other))
-        return isCollidingWithCube(*cube, outNormal, penetrationDepth);
-
-	// Check if it's a Capsule
-	if (const Capsule* capsule = dynamic_cast<const Capsule*>(&other))
-		return isCollidingWithCapsule(*capsule, outNormal, penetrationDepth);
-
-    return false;
+    const XMFLOAT3& center = getPosition();
+    outMin = { center.x - _radius, center.y - _radius, center.z - _radius };
+    outMax = { center.x + _radius, center.y + _radius, center.z + _radius };
+    return true;
 }
 
 bool Sphere::isCollidingWithSphere(const Sphere& other, DirectX::XMFLOAT3& outNormal, float& penetrationDepth) const
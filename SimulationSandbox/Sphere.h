@@ -11,10 +11,10 @@ public:
 		DirectX::XMFLOAT3 position = { 0.0f, 0.0f, 0.0f },
 		DirectX::XMFLOAT3 rotation = { 0.0f, 0.0f, 0.0f },
 		DirectX::XMFLOAT3 scale = { 1.0f, 1.0f, 1.0f })
-		: Collider(position, rotation, scale) { _radius = scale.x; }
+		: Collider(ShapeType::SPHERE, position, rotation, scale) { _radius = scale.x; }
 	~Sphere() = default;
 
-	bool isColliding(const Collider& other, DirectX::XMFLOAT3& outNormal, float& penetrationDepth) const override;
+	bool getBounds(DirectX::XMFLOAT3& outMin, DirectX::XMFLOAT3& outMax) const override;
 	bool isCollidingWithSphere(const Sphere& sphere, DirectX::XMFLOAT3& outNormal, float& penetrationDepth) const;
 	bool isCollidingWithPlane(const Plane& plane, DirectX::XMFLOAT3& outNormal, float& penetrationDepth) const;
 	bool isCollidingWithCylinder(const Cylinder& cylinder, DirectX::XMFLOAT3& outNormal, float& penetrationDepth) const;
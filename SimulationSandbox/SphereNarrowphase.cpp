@@ -0,0 +1,268 @@
+#include "SphereNarrowphase.h"
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SPHERE_NARROWPHASE_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC accepts every intrinsic anywhere; GCC and Clang need the target per function
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SIMD_TARGET(isa)
+#endif
+
+// Which pairs fall in the scalar tail depends on how the pairs are chunked, so the tail has to round
+// exactly like the lanes or the contacts change with the thread count. No a * b + c may become an FMA,
+// which GCC does once a target such as avx512f allows it.
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#elif defined(_MSC_VER)
+#pragma fp_contract(off)
+#endif
+
+namespace
+{
+	const float contactEpsilon = 1e-4f; // slack so resting bodies keep their contacts
+
+	// Second half of the test, only run for pairs that passed the distance check
+	void emitContact(int bodyA, int bodyB, float dx, float dy, float dz, float distanceSquared, float sumRadii, std::vector<SphereContact>& contacts)
+	{
+		SphereContact contact;
+		contact.bodyA = bodyA;
+		contact.bodyB = bodyB;
+
+		float distance = sqrtf(distanceSquared);
+		if (distance > 1e-5f)
+		{
+			contact.normalX = dx / distance; contact.normalY = dy / distance; contact.normalZ = dz / distance;
+		}
+		else
+		{
+			contact.normalX = 1.0f; contact.normalY = 0.0f; contact.normalZ = 0.0f; // Arbitrary direction
+		}
+		contact.depth = sumRadii - distance;
+		contacts.push_back(contact);
+	}
+
+	void testPair(const BodyStore& bodies, int bodyA, int bodyB, std::vector<SphereContact>& contacts)
+	{
+		float dx = bodies.posX[bodyA] - bodies.posX[bodyB];
+		float dy = bodies.posY[bodyA] - bodies.posY[bodyB];
+		float dz = bodies.posZ[bodyA] - bodies.posZ[bodyB];
+		float distanceSquared = dx * dx + dy * dy + dz * dz;
+		float sumRadii = bodies.radius[bodyA] + bodies.radius[bodyB];
+
+		if (distanceSquared > sumRadii * sumRadii + contactEpsilon) return;
+		emitContact(bodyA, bodyB, dx, dy, dz, distanceSquared, sumRadii, contacts);
+	}
+
+	void testScalar(const BodyStore& bodies, const int* bodiesA, const int* bodiesB, int count, std::vector<SphereContact>& contacts)
+	{
+		for (int k = 0; k < count; ++k)
+		{
+			testPair(bodies, bodiesA[k], bodiesB[k], contacts);
+		}
+	}
+
+#ifdef SPHERE_NARROWPHASE_X86
+	// Lanes of one SIMD group, spilled for the few pairs that touch
+	struct LaneData
+	{
+		alignas(64) float dx[16];
+		alignas(64) float dy[16];
+		alignas(64) float dz[16];
+		alignas(64) float distanceSquared[16];
+		alignas(64) float sumRadii[16];
+	};
+
+	void emitLanes(const LaneData& lanes, unsigned mask, const int* bodiesA, const int* bodiesB, std::vector<SphereContact>& contacts)
+	{
+		for (int lane = 0; mask != 0; ++lane, mask >>= 1)
+		{
+			if (mask & 1u)
+			{
+				emitContact(bodiesA[lane], bodiesB[lane], lanes.dx[lane], lanes.dy[lane], lanes.dz[lane], lanes.distanceSquared[lane], lanes.sumRadii[lane], contacts);
+			}
+		}
+	}
+
+	SIMD_TARGET("sse2")
+	void testSSE(const BodyStore& bodies, const int* bodiesA, const int* bodiesB, int count, std::vector<SphereContact>& contacts)
+	{
+		const float* posX = bodies.posX.data();
+		const float* posY = bodies.posY.data();
+		const float* posZ = bodies.posZ.data();
+		const float* radius = bodies.radius.data();
+		const __m128 epsilon = _mm_set1_ps(contactEpsilon);
+		LaneData lanes;
+
+		// SSE has no gather, so the lanes are filled one by one
+		auto load = [](const float* values, const int* indices)
+			{
+				return _mm_set_ps(values[indices[3]], values[indices[2]], values[indices[1]], values[indices[0]]);
+			};
+
+		int k = 0;
+		for (; k + 4 <= count; k += 4)
+		{
+			const int* a = bodiesA + k;
+			const int* b = bodiesB + k;
+			__m128 dx = _mm_sub_ps(load(posX, a), load(posX, b));
+			__m128 dy = _mm_sub_ps(load(posY, a), load(posY, b));
+			__m128 dz = _mm_sub_ps(load(posZ, a), load(posZ, b));
+			__m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			__m128 sumRadii = _mm_add_ps(load(radius, a), load(radius, b));
+
+			// "not greater than" keeps the scalar early-out exactly, NaN included
+			unsigned mask = static_cast<unsigned>(_mm_movemask_ps(_mm_cmpngt_ps(distanceSquared, _mm_add_ps(_mm_mul_ps(sumRadii, sumRadii), epsilon))));
+			if (mask == 0) continue;
+
+			_mm_store_ps(lanes.dx, dx); _mm_store_ps(lanes.dy, dy); _mm_store_ps(lanes.dz, dz);
+			_mm_store_ps(lanes.distanceSquared, distanceSquared); _mm_store_ps(lanes.sumRadii, sumRadii);
+			emitLanes(lanes, mask, a, b, contacts);
+		}
+		testScalar(bodies, bodiesA + k, bodiesB + k, count - k, contacts);
+	}
+
+	SIMD_TARGET("avx2")
+	void testAVX2(const BodyStore& bodies, const int* bodiesA, const int* bodiesB, int count, std::vector<SphereContact>& contacts)
+	{
+		const float* posX = bodies.posX.data();
+		const float* posY = bodies.posY.data();
+		const float* posZ = bodies.posZ.data();
+		const float* radius = bodies.radius.data();
+		const __m256 epsilon = _mm256_set1_ps(contactEpsilon);
+		LaneData lanes;
+
+		int k = 0;
+		for (; k + 8 <= count; k += 8)
+		{
+			const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bodiesA + k));
+			const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bodiesB + k));
+			__m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(posX, a, 4), _mm256_i32gather_ps(posX, b, 4));
+			__m256 dy = _mm256_sub_ps(_mm256_i32gather_ps(posY, a, 4), _mm256_i32gather_ps(posY, b, 4));
+			__m256 dz = _mm256_sub_ps(_mm256_i32gather_ps(posZ, a, 4), _mm256_i32gather_ps(posZ, b, 4));
+			__m256 distanceSquared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+			__m256 sumRadii = _mm256_add_ps(_mm256_i32gather_ps(radius, a, 4), _mm256_i32gather_ps(radius, b, 4));
+
+			__m256 threshold = _mm256_add_ps(_mm256_mul_ps(sumRadii, sumRadii), epsilon);
+			unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(distanceSquared, threshold, _CMP_NGT_UQ)));
+			if (mask == 0) continue;
+
+			_mm256_store_ps(lanes.dx, dx); _mm256_store_ps(lanes.dy, dy); _mm256_store_ps(lanes.dz, dz);
+			_mm256_store_ps(lanes.distanceSquared, distanceSquared); _mm256_store_ps(lanes.sumRadii, sumRadii);
+			emitLanes(lanes, mask, bodiesA + k, bodiesB + k, contacts);
+		}
+		testScalar(bodies, bodiesA + k, bodiesB + k, count - k, contacts);
+	}
+
+	SIMD_TARGET("avx512f")
+	void testAVX512(const BodyStore& bodies, const int* bodiesA, const int* bodiesB, int count, std::vector<SphereContact>& contacts)
+	{
+		const float* posX = bodies.posX.data();
+		const float* posY = bodies.posY.data();
+		const float* posZ = bodies.posZ.data();
+		const float* radius = bodies.radius.data();
+		const __m512 epsilon = _mm512_set1_ps(contactEpsilon);
+		LaneData lanes;
+
+		int k = 0;
+		for (; k + 16 <= count; k += 16)
+		{
+			const __m512i a = _mm512_loadu_si512(bodiesA + k);
+			const __m512i b = _mm512_loadu_si512(bodiesB + k);
+			__m512 dx = _mm512_sub_ps(_mm512_i32gather_ps(a, posX, 4), _mm512_i32gather_ps(b, posX, 4));
+			__m512 dy = _mm512_sub_ps(_mm512_i32gather_ps(a, posY, 4), _mm512_i32gather_ps(b, posY, 4));
+			__m512 dz = _mm512_sub_ps(_mm512_i32gather_ps(a, posZ, 4), _mm512_i32gather_ps(b, posZ, 4));
+			__m512 distanceSquared = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy)), _mm512_mul_ps(dz, dz));
+			__m512 sumRadii = _mm512_add_ps(_mm512_i32gather_ps(a, radius, 4), _mm512_i32gather_ps(b, radius, 4));
+
+			__m512 threshold = _mm512_add_ps(_mm512_mul_ps(sumRadii, sumRadii), epsilon);
+			unsigned mask = static_cast<unsigned>(_mm512_cmp_ps_mask(distanceSquared, threshold, _CMP_NGT_UQ));
+			if (mask == 0) continue;
+
+			_mm512_store_ps(lanes.dx, dx); _mm512_store_ps(lanes.dy, dy); _mm512_store_ps(lanes.dz, dz);
+			_mm512_store_ps(lanes.distanceSquared, distanceSquared); _mm512_store_ps(lanes.sumRadii, sumRadii);
+			emitLanes(lanes, mask, bodiesA + k, bodiesB + k, contacts);
+		}
+		testScalar(bodies, bodiesA + k, bodiesB + k, count - k, contacts);
+	}
+
+	SimdLevel detectLevel()
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		const int maxLeaf = info[0];
+
+		__cpuid(info, 1);
+		const bool sse2 = (info[3] & (1 << 26)) != 0;
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		const bool avx = (info[2] & (1 << 28)) != 0;
+		if (!sse2) return SimdLevel::SCALAR;
+		if (!osxsave || !avx || maxLeaf < 7) return SimdLevel::SSE;
+
+		// The OS must save the wider registers on context switches
+		const unsigned long long xcr0 = _xgetbv(0);
+		const bool ymmState = (xcr0 & 0x6) == 0x6;
+		const bool zmmState = (xcr0 & 0xe6) == 0xe6;
+
+		__cpuidex(info, 7, 0);
+		const bool avx2 = (info[1] & (1 << 5)) != 0;
+		const bool avx512f = (info[1] & (1 << 16)) != 0;
+
+		if (avx512f && zmmState) return SimdLevel::AVX512;
+		if (avx2 && ymmState) return SimdLevel::AVX2;
+		return SimdLevel::SSE;
+#else
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f")) return SimdLevel::AVX512;
+		if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+		if (__builtin_cpu_supports("sse2")) return SimdLevel::SSE;
+		return SimdLevel::SCALAR;
+#endif
+	}
+#else
+	SimdLevel detectLevel() { return SimdLevel::SCALAR; }
+#endif
+}
+
+SimdLevel SphereNarrowphase::getSupportedLevel()
+{
+	static const SimdLevel supportedLevel = detectLevel();
+	return supportedLevel;
+}
+
+const wchar_t* SphereNarrowphase::getLevelName(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::SSE: return L"SSE";
+	case SimdLevel::AVX2: return L"AVX2";
+	case SimdLevel::AVX512: return L"AVX-512";
+	default: return L"scalar";
+	}
+}
+
+void SphereNarrowphase::setLevel(SimdLevel level)
+{
+	if (static_cast<int>(level) > static_cast<int>(getSupportedLevel())) level = getSupportedLevel();
+	_level = level;
+
+	switch (level)
+	{
+#ifdef SPHERE_NARROWPHASE_X86
+	case SimdLevel::SSE: _kernel = testSSE; break;
+	case SimdLevel::AVX2: _kernel = testAVX2; break;
+	case SimdLevel::AVX512: _kernel = testAVX512; break;
+#endif
+	default: _kernel = testScalar; break;
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <vector>
+#include "BodyStore.h"
+
+// Instruction set used by the sphere-sphere kernel
+enum class SimdLevel
+{
+	SCALAR,
+	SSE,    // 4 pairs at a time
+	AVX2,   // 8 pairs at a time
+	AVX512  // 16 pairs at a time
+};
+
+// Compact result of a sphere-sphere test. The normal points from bodyB towards bodyA.
+struct SphereContact
+{
+	int bodyA;
+	int bodyB;
+	float normalX, normalY, normalZ;
+	float depth;
+};
+
+// Batched sphere-sphere narrowphase over the body store.
+// Candidate pairs are tested several at a time with the widest instruction set the CPU
+// supports (picked at runtime), and only touching pairs come out as contacts. Every level
+// runs the same test, so every level finds exactly the same contacts.
+class SphereNarrowphase
+{
+public:
+	static constexpr int BATCH_SIZE = 256;
+
+	using Kernel = void (*)(const BodyStore& bodies, const int* bodiesA, const int* bodiesB, int count, std::vector<SphereContact>& contacts);
+
+private:
+	SimdLevel _level = SimdLevel::SCALAR;
+	Kernel _kernel = nullptr;
+
+public:
+	SphereNarrowphase() { setLevel(getSupportedLevel()); }
+
+	// Widest level this CPU (and OS) can run, detected once
+	static SimdLevel getSupportedLevel();
+	static const wchar_t* getLevelName(SimdLevel level);
+
+	// Anything above the supported level falls back to it
+	void setLevel(SimdLevel level);
+	SimdLevel getLevel() const { return _level; }
+
+	// Appends a contact for every touching pair (bodiesA[k], bodiesB[k])
+	void test(const BodyStore& bodies, const int* bodiesA, const int* bodiesB, int count, std::vector<SphereContact>& contacts) const
+	{
+		_kernel(bodies, bodiesA, bodiesB, count, contacts);
+	}
+};
+
+// Collects candidate pairs from a broadphase and tests them in full batches.
+// Lives on the stack of one thread; flush() must be called after the last pair.
+class SpherePairBatch
+{
+private:
+	const SphereNarrowphase& _narrowphase;
+	const BodyStore& _bodies;
+	std::vector<SphereContact>& _contacts;
+
+	int _bodiesA[SphereNarrowphase::BATCH_SIZE];
+	int _bodiesB[SphereNarrowphase::BATCH_SIZE];
+	int _count = 0;
+
+public:
+	SpherePairBatch(const SphereNarrowphase& narrowphase, const BodyStore& bodies, std::vector<SphereContact>& contacts)
+		: _narrowphase(narrowphase), _bodies(bodies), _contacts(contacts)
+	{
+	}
+
+	void add(int bodyA, int bodyB)
+	{
+		_bodiesA[_count] = bodyA;
+		_bodiesB[_count] = bodyB;
+		if (++_count == SphereNarrowphase::BATCH_SIZE) flush();
+	}
+
+	void flush()
+	{
+		if (_count == 0) return;
+		_narrowphase.test(_bodies, _bodiesA, _bodiesB, _count, _contacts);
+		_count = 0;
+	}
+};
@@ -0,0 +1,90 @@
+#include "StaticBVH.h"
+#include <algorithm>
+#include <cfloat>
+
+void StaticBVH::clear()
+{
+	_nodes.clear();
+	_indices.clear();
+	_itemIds.clear();
+	_itemMin.clear();
+	_itemMax.clear();
+}
+
+void StaticBVH::build(const std::vector<int>& ids, const std::vector<DirectX::XMFLOAT3>& boundsMin, const std::vector<DirectX::XMFLOAT3>& boundsMax)
+{
+	clear();
+	if (ids.empty()) return;
+
+	_itemIds = ids;
+	_itemMin = boundsMin;
+	_itemMax = boundsMax;
+
+	_indices.resize(ids.size());
+	for (size_t i = 0; i < ids.size(); ++i)
+	{
+		_indices[i] = static_cast<int>(i);
+	}
+
+	_nodes.reserve(ids.size() * 2);
+	buildNode(0, static_cast<int>(ids.size()), 0);
+}
+
+int StaticBVH::buildNode(int begin, int end, int depth)
+{
+	const int nodeIndex = static_cast<int>(_nodes.size());
+	_nodes.push_back({});
+
+	// Bounds of the items and of their centres
+	DirectX::XMFLOAT3 boundsMin = _itemMin[_indices[begin]];
+	DirectX::XMFLOAT3 boundsMax = _itemMax[_indices[begin]];
+	DirectX::XMFLOAT3 centreMin = { FLT_MAX, FLT_MAX, FLT_MAX };
+	DirectX::XMFLOAT3 centreMax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+	for (int k = begin; k < end; ++k)
+	{
+		const DirectX::XMFLOAT3& itemMin = _itemMin[_indices[k]];
+		const DirectX::XMFLOAT3& itemMax = _itemMax[_indices[k]];
+		boundsMin = { std::min(boundsMin.x, itemMin.x), std::min(boundsMin.y, itemMin.y), std::min(boundsMin.z, itemMin.z) };
+		boundsMax = { std::max(boundsMax.x, itemMax.x), std::max(boundsMax.y, itemMax.y), std::max(boundsMax.z, itemMax.z) };
+
+		DirectX::XMFLOAT3 centre = { (itemMin.x + itemMax.x) * 0.5f, (itemMin.y + itemMax.y) * 0.5f, (itemMin.z + itemMax.z) * 0.5f };
+		centreMin = { std::min(centreMin.x, centre.x), std::min(centreMin.y, centre.y), std::min(centreMin.z, centre.z) };
+		centreMax = { std::max(centreMax.x, centre.x), std::max(centreMax.y, centre.y), std::max(centreMax.z, centre.z) };
+	}
+
+	_nodes[nodeIndex].boundsMin = boundsMin;
+	_nodes[nodeIndex].boundsMax = boundsMax;
+
+	// The query stack holds at most one entry per level plus one
+	if (end - begin <= MAX_LEAF_SIZE || depth >= MAX_DEPTH - 2)
+	{
+		_nodes[nodeIndex].first = begin;
+		_nodes[nodeIndex].count = end - begin;
+		return nodeIndex;
+	}
+
+	// Median split along the widest spread of centres
+	float spreadX = centreMax.x - centreMin.x;
+	float spreadY = centreMax.y - centreMin.y;
+	float spreadZ = centreMax.z - centreMin.z;
+	int axis = (spreadX >= spreadY && spreadX >= spreadZ) ? 0 : (spreadY >= spreadZ ? 1 : 2);
+
+	auto centreOnAxis = [&](int slot)
+		{
+			const float* itemMin = &_itemMin[slot].x;
+			const float* itemMax = &_itemMax[slot].x;
+			return itemMin[axis] + itemMax[axis];
+		};
+
+	const int middle = begin + (end - begin) / 2;
+	std::nth_element(_indices.begin() + begin, _indices.begin() + middle, _indices.begin() + end,
+		[&](int a, int b) { return centreOnAxis(a) < centreOnAxis(b); });
+
+	buildNode(begin, middle, depth + 1); // left child sits right after this node
+	const int right = buildNode(middle, end, depth + 1);
+
+	_nodes[nodeIndex].first = right;
+	_nodes[nodeIndex].count = 0;
+	return nodeIndex;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <vector>
+#include <DirectXMath.h>
+
+// Bounding volume hierarchy over objects that never move.
+// Built once from a list of boxes, then only queried. Nodes live in one flat array in
+// depth-first order; a leaf holds a short run of 'indices'.
+class StaticBVH
+{
+private:
+	struct Node
+	{
+		DirectX::XMFLOAT3 boundsMin;
+		DirectX::XMFLOAT3 boundsMax;
+		int first; // leaf: first slot in _indices, inner node: index of the right child (left child follows the node)
+		int count; // leaf: number of items, 0 for inner nodes
+	};
+
+	static constexpr int MAX_LEAF_SIZE = 2;
+	static constexpr int MAX_DEPTH = 64;
+
+	std::vector<Node> _nodes;
+	std::vector<int> _indices; // item slots, grouped by leaf
+	std::vector<int> _itemIds;
+	std::vector<DirectX::XMFLOAT3> _itemMin;
+	std::vector<DirectX::XMFLOAT3> _itemMax;
+
+	int buildNode(int begin, int end, int depth);
+
+	static bool overlaps(const DirectX::XMFLOAT3& minA, const DirectX::XMFLOAT3& maxA, const DirectX::XMFLOAT3& minB, const DirectX::XMFLOAT3& maxB)
+	{
+		return minA.x <= maxB.x && maxA.x >= minB.x
+			&& minA.y <= maxB.y && maxA.y >= minB.y
+			&& minA.z <= maxB.z && maxA.z >= minB.z;
+	}
+
+public:
+	void clear();
+	// Items are identified by 'ids[k]', their boxes are 'boundsMin[k]'..'boundsMax[k]'
+	void build(const std::vector<int>& ids, const std::vector<DirectX::XMFLOAT3>& boundsMin, const std::vector<DirectX::XMFLOAT3>& boundsMax);
+
+	bool empty() const { return _nodes.empty(); }
+	size_t getNodeCount() const { return _nodes.size(); }
+
+	// Calls fn(id) for every item whose box overlaps the query box
+	template <typename Fn>
+	void query(const DirectX::XMFLOAT3& queryMin, const DirectX::XMFLOAT3& queryMax, Fn&& fn) const
+	{
+		if (_nodes.empty()) return;
+
+		int stack[MAX_DEPTH];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const int nodeIndex = stack[--stackSize];
+			const Node& node = _nodes[nodeIndex];
+			if (!overlaps(queryMin, queryMax, node.boundsMin, node.boundsMax)) continue;
+
+			if (node.count > 0)
+			{
+				for (int k = node.first; k < node.first + node.count; ++k)
+				{
+					const int slot = _indices[k];
+					if (overlaps(queryMin, queryMax, _itemMin[slot], _itemMax[slot])) fn(_itemIds[slot]);
+				}
+				continue;
+			}
+
+			stack[stackSize++] = node.first;     // right child
+			stack[stackSize++] = nodeIndex + 1;  // left child
+		}
+	}
+};
@@ -0,0 +1,224 @@
+#include "SweepAndPrune.h"
+#include <algorithm>
+
+void SweepAndPrune::reset()
+{
+	for (int axis = 0; axis < 2; ++axis)
+	{
+		_endpoints[axis].clear();
+		_boxMin[axis].clear();
+		_boxMax[axis].clear();
+	}
+	_pairs.clear();
+	_pairSlots.clear();
+	_numBodies = 0;
+}
+
+void SweepAndPrune::updateBoxes(const BodyStore& bodies)
+{
+	const size_t count = bodies.size();
+	const std::vector<float>* positions[3] = { &bodies.posX, &bodies.posY, &bodies.posZ };
+
+	for (int axis = 0; axis < 2; ++axis)
+	{
+		_boxMin[axis].resize(count);
+		_boxMax[axis].resize(count);
+
+		const std::vector<float>& pos = *positions[_axes[axis]];
+		for (size_t i = 0; i < count; ++i)
+		{
+			float extent = bodies.radius[i] + _margin;
+			_boxMin[axis][i] = pos[i] - extent;
+			_boxMax[axis][i] = pos[i] + extent;
+		}
+
+		for (Endpoint& endpoint : _endpoints[axis])
+		{
+			int body = endpoint.getBody();
+			endpoint.value = endpoint.isMax() ? _boxMax[axis][body] : _boxMin[axis][body];
+		}
+	}
+}
+
+void SweepAndPrune::chooseAxes(const BodyStore& bodies)
+{
+	const std::vector<float>* positions[3] = { &bodies.posX, &bodies.posY, &bodies.posZ };
+	const size_t count = bodies.size();
+	if (count < 2) return;
+
+	// Drop the axis with the smallest variance
+	float variance[3];
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		const std::vector<float>& pos = *positions[axis];
+		double sum = 0.0, sumSquares = 0.0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			sum += pos[i];
+			sumSquares += static_cast<double>(pos[i]) * pos[i];
+		}
+		double mean = sum / count;
+		variance[axis] = static_cast<float>(sumSquares / count - mean * mean);
+	}
+
+	int dropped = 0;
+	if (variance[1] < variance[dropped]) dropped = 1;
+	if (variance[2] < variance[dropped]) dropped = 2;
+	_axes[0] = dropped == 0 ? 1 : 0;
+	_axes[1] = dropped == 2 ? 1 : 2;
+}
+
+bool SweepAndPrune::boxesOverlap(int a, int b) const
+{
+	for (int axis = 0; axis < 2; ++axis)
+	{
+		if (_boxMin[axis][a] >= _boxMax[axis][b] || _boxMin[axis][b] >= _boxMax[axis][a]) return false;
+	}
+	return true;
+}
+
+void SweepAndPrune::addPair(int a, int b)
+{
+	uint64_t key = makeKey(a, b);
+	if (_pairSlots.try_emplace(key, static_cast<int>(_pairs.size())).second)
+	{
+		_pairs.push_back(key);
+	}
+}
+
+void SweepAndPrune::removePair(int a, int b)
+{
+	auto it = _pairSlots.find(makeKey(a, b));
+	if (it == _pairSlots.end()) return;
+
+	// Swap-remove, keeping the slot of the moved pair valid
+	int slot = it->second;
+	uint64_t last = _pairs.back();
+	_pairs[slot] = last;
+	_pairSlots[last] = slot;
+	_pairs.pop_back();
+	_pairSlots.erase(it);
+}
+
+void SweepAndPrune::sortAxis(int axis)
+{
+	std::vector<Endpoint>& endpoints = _endpoints[axis];
+
+	for (size_t i = 1; i < endpoints.size(); ++i)
+	{
+		const Endpoint key = endpoints[i];
+		size_t j = i;
+
+		while (j > 0 && endpoints[j - 1].value > key.value)
+		{
+			const Endpoint& other = endpoints[j - 1];
+
+			if (!key.isMax() && other.isMax())
+			{
+				// Our min passed their max: the boxes start to overlap on this axis
+				if (boxesOverlap(key.getBody(), other.getBody()))
+				{
+					addPair(key.getBody(), other.getBody());
+				}
+			}
+			else if (key.isMax() && !other.isMax())
+			{
+				// Our max passed their min: the boxes no longer overlap on this axis
+				removePair(key.getBody(), other.getBody());
+			}
+
+			endpoints[j] = other;
+			--j;
+		}
+		endpoints[j] = key;
+	}
+}
+
+void SweepAndPrune::appendBodies(size_t first, size_t last)
+{
+	// New endpoints start at the far end, past everything, so the next insertion sort
+	// moves them into place and reports their overlaps like any other motion.
+	for (int axis = 0; axis < 2; ++axis)
+	{
+		for (size_t i = first; i < last; ++i)
+		{
+			uint32_t data = static_cast<uint32_t>(i) << 1;
+			_endpoints[axis].push_back({ _boxMin[axis][i], data });
+			_endpoints[axis].push_back({ _boxMax[axis][i], data | 1u });
+		}
+	}
+}
+
+void SweepAndPrune::rebuild()
+{
+	_pairs.clear();
+	_pairSlots.clear();
+
+	for (int axis = 0; axis < 2; ++axis)
+	{
+		std::vector<Endpoint>& endpoints = _endpoints[axis];
+		endpoints.clear();
+		endpoints.reserve(_numBodies * 2);
+		for (size_t i = 0; i < _numBodies; ++i)
+		{
+			uint32_t data = static_cast<uint32_t>(i) << 1;
+			endpoints.push_back({ _boxMin[axis][i], data });
+			endpoints.push_back({ _boxMax[axis][i], data | 1u });
+		}
+		std::sort(endpoints.begin(), endpoints.end(), [](const Endpoint& a, const Endpoint& b)
+			{
+				// Max before min on ties: touching boxes do not overlap, as in boxesOverlap
+				return a.value < b.value || (a.value == b.value && a.isMax() && !b.isMax());
+			});
+	}
+
+	// One sweep along the first axis finds every overlapping pair
+	std::vector<int> active;
+	std::vector<int> activeSlot(_numBodies, -1);
+	for (const Endpoint& endpoint : _endpoints[0])
+	{
+		int body = endpoint.getBody();
+		if (endpoint.isMax())
+		{
+			int slot = activeSlot[body];
+			activeSlot[active.back()] = slot;
+			active[slot] = active.back();
+			active.pop_back();
+			continue;
+		}
+
+		for (int other : active)
+		{
+			if (boxesOverlap(body, other)) addPair(body, other);
+		}
+		activeSlot[body] = static_cast<int>(active.size());
+		active.push_back(body);
+	}
+}
+
+void SweepAndPrune::update(const BodyStore& bodies)
+{
+	const size_t count = bodies.size();
+	if (count < _numBodies) reset(); // the store was cleared behind our back
+
+	// Sorting a large batch of new bodies in one by one is quadratic, so start over instead
+	const size_t added = count - _numBodies;
+	const bool bRebuild = _numBodies == 0 || added > 1024 || added * 8 > count;
+	if (bRebuild)
+	{
+		chooseAxes(bodies);
+		updateBoxes(bodies);
+		_numBodies = count;
+		rebuild();
+		return;
+	}
+
+	updateBoxes(bodies);
+	appendBodies(_numBodies, count);
+	_numBodies = count;
+
+	for (int axis = 0; axis < 2; ++axis)
+	{
+		sortAxis(axis);
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include "BodyStore.h"
+
+// Incremental sweep-and-prune over the bounding boxes of the moving bodies.
+// The endpoint lists stay sorted across ticks and are repaired with an insertion sort, which
+// is close to linear while bodies only move a little per tick. Every swap where two boxes
+// start or stop overlapping updates a persistent pair set, so settled piles cost almost nothing.
+//
+// Only the two axes with the widest spread are swept. Piles are flat, so on the third (the
+// gravity axis) nearly every box overlaps every other and the sort would thrash for nothing.
+// Pairs are therefore boxes that overlap on the swept axes; the narrowphase checks the rest.
+class SweepAndPrune
+{
+private:
+	struct Endpoint
+	{
+		float value;
+		uint32_t data; // body index << 1, lowest bit set for a max endpoint
+
+		int getBody() const { return static_cast<int>(data >> 1); }
+		bool isMax() const { return (data & 1u) != 0; }
+	};
+
+	int _axes[2] = { 0, 2 }; // swept axes, picked on every rebuild
+	std::vector<Endpoint> _endpoints[2];
+	std::vector<float> _boxMin[2];
+	std::vector<float> _boxMax[2];
+
+	// Overlapping pairs, packed as (smaller index << 32 | larger index)
+	std::vector<uint64_t> _pairs;
+	std::unordered_map<uint64_t, int> _pairSlots; // pair -> index in _pairs, for O(1) removal
+
+	size_t _numBodies = 0;
+	float _margin = 0.005f; // boxes are inflated so touching spheres are never missed
+
+	static uint64_t makeKey(int a, int b)
+	{
+		if (a > b) std::swap(a, b);
+		return (static_cast<uint64_t>(a) << 32) | static_cast<uint32_t>(b);
+	}
+
+	void updateBoxes(const BodyStore& bodies);
+	void chooseAxes(const BodyStore& bodies);
+	void rebuild();
+	void appendBodies(size_t first, size_t last);
+	void sortAxis(int axis);
+	bool boxesOverlap(int a, int b) const;
+	void addPair(int a, int b);
+	void removePair(int a, int b);
+
+public:
+	// Brings the sorted endpoints and the pair set up to date with the current body positions.
+	// Bodies are only ever appended to the store; anything else needs a reset first.
+	void update(const BodyStore& bodies);
+	void reset();
+
+	size_t getPairCount() const { return _pairs.size(); }
+	void getPair(size_t k, int& a, int& b) const
+	{
+		a = static_cast<int>(_pairs[k] >> 32);
+		b = static_cast<int>(_pairs[k] & 0xffffffffu);
+	}
+
+	void setMargin(float margin) { _margin = margin; }
+	float getMargin() const { return _margin; }
+};
@@ -0,0 +1,18 @@
+#include "SweptSphere.h"
+
+float SweptSphere::sweepSpheres(const DirectX::XMFLOAT3& offset, const DirectX::XMFLOAT3& motion, float radiusSum)
+{
+	// |offset + t * motion| = radiusSum, a quadratic in t
+	const float a = motion.x * motion.x + motion.y * motion.y + motion.z * motion.z;
+	const float b = offset.x * motion.x + offset.y * motion.y + offset.z * motion.z;
+	const float c = offset.x * offset.x + offset.y * offset.y + offset.z * offset.z - radiusSum * radiusSum;
+
+	if (c <= 0.0f) return NO_HIT; // already touching
+	if (b >= 0.0f || a <= 1e-12f) return NO_HIT; // moving apart, or not relative to each other
+
+	const float discriminant = b * b - a * c;
+	if (discriminant < 0.0f) return NO_HIT; // passing by
+
+	const float t = (-b - std::sqrt(discriminant)) / a;
+	return t <= 1.0f ? t : NO_HIT;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <DirectXMath.h>
+#include <cmath>
+
+// Time of impact for a sphere that moves further in one tick than its size allows the discrete
+// tests to see. Times are fractions of the tick's motion, 0 at the start and 1 at the end.
+class SweptSphere
+{
+public:
+	static constexpr float NO_HIT = 2.0f; // past the end of the motion
+	static constexpr int BISECTION_STEPS = 8;
+
+	// First time two spheres moving in straight lines touch. 'offset' is A - B at the start and
+	// 'motion' is A's motion relative to B. Spheres that already overlap at the start are left to
+	// the contact solver.
+	static float sweepSpheres(const DirectX::XMFLOAT3& offset, const DirectX::XMFLOAT3& motion, float radiusSum);
+
+	// First time 'isTouching(t)' holds, for shapes with no closed form. The motion is sampled in
+	// steps of at most 'maxStep', then the first touching step is bisected. Returns a time at which
+	// the shapes touch (within the bisection precision), so the next tick finds the contact.
+	// Touching at the start gives 0: the caller only counts contacts the motion drives into.
+	template <typename Fn>
+	static float sweepSampled(float maxStep, Fn&& isTouching)
+	{
+		if (isTouching(0.0f)) return 0.0f;
+
+		const int numSteps = static_cast<int>(std::ceil(1.0f / maxStep));
+		for (int step = 1; step <= numSteps; ++step)
+		{
+			const float end = static_cast<float>(step) / numSteps;
+			if (!isTouching(end)) continue;
+
+			float clear = static_cast<float>(step - 1) / numSteps;
+			float touching = end;
+			for (int i = 0; i < BISECTION_STEPS; ++i)
+			{
+				const float middle = 0.5f * (clear + touching);
+				if (isTouching(middle)) touching = middle;
+				else clear = middle;
+			}
+			return touching;
+		}
+		return NO_HIT;
+	}
+};
@@ -0,0 +1,224 @@
+#include "TaskScheduler.h"
+
+thread_local int TaskScheduler::t_workerIndex = 0;
+
+void TaskScheduler::start(int numWorkers, const std::function<void(int)>& onWorkerStart)
+{
+	stop();
+
+	numWorkers = std::max(1, numWorkers);
+	_stopping.store(false);
+	for (int i = 0; i < numWorkers; ++i)
+	{
+		_workers.push_back(std::make_unique<Worker>());
+	}
+
+	_threads.reserve(numWorkers - 1);
+	for (int i = 1; i < numWorkers; ++i)
+	{
+		_threads.emplace_back([this, i, onWorkerStart]() {
+			t_workerIndex = i;
+			if (onWorkerStart) onWorkerStart(i);
+			workerLoop(i);
+			});
+	}
+}
+
+void TaskScheduler::stop()
+{
+	if (_workers.empty()) return;
+
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_stopping.store(true);
+	}
+	_wakeCondition.notify_all();
+
+	for (auto& thread : _threads)
+	{
+		if (thread.joinable()) thread.join();
+	}
+	_threads.clear();
+	_workers.clear();
+	_numQueued.store(0);
+}
+
+void TaskScheduler::push(const Task& task)
+{
+	Worker& worker = *_workers[t_workerIndex];
+	{
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.tasks.push_back(task);
+	}
+
+	// A worker going to sleep counts itself before it checks for tasks, and the task is counted
+	// before the sleepers are, so one of the two always sees the other. Blocked waiters count
+	// themselves the same way and come back to help.
+	_numQueued.fetch_add(1);
+	if (_numSleeping.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_wakeCondition.notify_all();
+	}
+	if (_numWaiting.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(_doneMutex);
+		_doneCondition.notify_all();
+	}
+}
+
+bool TaskScheduler::popOrSteal(int self, Task& task)
+{
+	if (_numQueued.load(std::memory_order_relaxed) == 0) return false;
+
+	// Own work first, newest first
+	const int numWorkers = static_cast<int>(_workers.size());
+	{
+		Worker& worker = *_workers[self];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		if (!worker.tasks.empty())
+		{
+			task = worker.tasks.back();
+			worker.tasks.pop_back();
+			_numQueued.fetch_sub(1);
+			return true;
+		}
+	}
+
+	// Then the oldest task of the next worker that has any
+	for (int k = 1; k < numWorkers; ++k)
+	{
+		Worker& victim = *_workers[(self + k) % numWorkers];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty())
+		{
+			task = victim.tasks.front();
+			victim.tasks.pop_front();
+			_numQueued.fetch_sub(1);
+			return true;
+		}
+	}
+	return false;
+}
+
+void TaskScheduler::execute(const Task& task)
+{
+	task.run(task.context, task.begin, task.end);
+
+	// Only the scheduler is touched after the count drops, the counter may be gone as soon as it is zero.
+	// The waiter counts itself before it checks the counter, so as in push() one of the two sees the other.
+	if (task.pending->fetch_sub(1) == 1 && _numWaiting.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(_doneMutex);
+		_doneCondition.notify_all();
+	}
+}
+
+void TaskScheduler::submit(RunFn run, const void* context, int begin, int end, Counter& pending)
+{
+	push({ run, context, begin, end, &pending });
+}
+
+void TaskScheduler::wait(const Counter& pending)
+{
+	const int self = t_workerIndex;
+	Task task;
+	int spins = 0;
+	while (pending.load(std::memory_order_acquire) > 0)
+	{
+		if (popOrSteal(self, task))
+		{
+			execute(task);
+			spins = 0;
+			continue;
+		}
+
+		// The last tasks are running elsewhere; they usually end soon, but a long one should not cost a core
+		if (++spins < SPINS_BEFORE_SLEEP)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// Until the counter is done or new work is queued, which this thread then runs like a worker
+		std::unique_lock<std::mutex> lock(_doneMutex);
+		_numWaiting.fetch_add(1);
+		_doneCondition.wait(lock, [this, &pending] { return pending.load(std::memory_order_acquire) == 0 || _numQueued.load() > 0; });
+		_numWaiting.fetch_sub(1);
+	}
+}
+
+void TaskScheduler::workerLoop(int worker)
+{
+	Task task;
+	int spins = 0;
+	while (!_stopping.load())
+	{
+		if (popOrSteal(worker, task))
+		{
+			execute(task);
+			spins = 0;
+			continue;
+		}
+
+		// Stay awake briefly, the next phase of a tick usually follows right away
+		if (++spins < SPINS_BEFORE_SLEEP)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		_numSleeping.fetch_add(1);
+		_wakeCondition.wait(lock, [this] { return _numQueued.load() > 0 || _stopping.load(); });
+		_numSleeping.fetch_sub(1);
+		spins = 0;
+	}
+}
+
+int TaskGraph::add(std::function<void()> job, std::initializer_list<int> dependencies)
+{
+	const int index = static_cast<int>(_nodes.size());
+	auto node = std::make_unique<Node>();
+	node->job = std::move(job);
+	node->numDependencies = static_cast<int>(dependencies.size());
+	for (int dependency : dependencies)
+	{
+		_nodes[dependency]->successors.push_back(index);
+	}
+	_nodes.push_back(std::move(node));
+	return index;
+}
+
+void TaskGraph::runNode(const void* context, int node, int)
+{
+	// The graph is only read here, apart from its atomic counters
+	TaskGraph& graph = *const_cast<TaskGraph*>(static_cast<const TaskGraph*>(context));
+	graph._nodes[node]->job();
+
+	// The successors are queued before this node counts as done, so the graph never looks finished early
+	for (int successor : graph._nodes[node]->successors)
+	{
+		if (graph._nodes[successor]->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			graph._scheduler->submit(runNode, context, successor, successor + 1, graph._remaining);
+		}
+	}
+}
+
+void TaskGraph::run(TaskScheduler& scheduler)
+{
+	_scheduler = &scheduler;
+	_remaining.store(static_cast<int>(_nodes.size()));
+	for (auto& node : _nodes)
+	{
+		node->pending.store(node->numDependencies);
+	}
+
+	for (int i = 0; i < static_cast<int>(_nodes.size()); ++i)
+	{
+		if (_nodes[i]->numDependencies == 0) scheduler.submit(runNode, this, i, i + 1, _remaining);
+	}
+	scheduler.wait(_remaining);
+	_scheduler = nullptr;
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+
+// Work-stealing thread pool for the simulation tick.
+// Every worker has its own deque of tasks. A worker pushes and pops at the back, so it goes on
+// with the work it has just split off while that is still in cache; an idle worker steals from
+// the front of another's deque, where the oldest and biggest pieces are. A thread that waits for
+// tasks runs tasks itself until they are done, so a task may split off more work and wait for it
+// without tying up a worker.
+// Worker 0 is the thread that drives the scheduler (the tick thread), the others are spawned by start().
+class TaskScheduler
+{
+public:
+	// Tasks still to finish, waited on by whoever submitted them
+	using Counter = std::atomic<int>;
+	using RunFn = void (*)(const void* context, int begin, int end);
+
+private:
+	struct Task
+	{
+		RunFn run;
+		const void* context;
+		int begin;
+		int end;
+		Counter* pending;
+	};
+
+	// Deques are short and only locked to push or take one task, so a mutex per deque is enough
+	struct alignas(64) Worker
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	static constexpr int SPINS_BEFORE_SLEEP = 256; // an idle worker, or a waiter with nothing to run, yields this often before it blocks
+
+	std::vector<std::unique_ptr<Worker>> _workers;
+	std::vector<std::thread> _threads;
+	std::atomic<int> _numQueued{ 0 };
+	std::atomic<int> _numSleeping{ 0 };
+	std::atomic<bool> _stopping{ false };
+	std::mutex _sleepMutex;
+	std::condition_variable _wakeCondition;
+	std::atomic<int> _numWaiting{ 0 }; // threads blocked in wait()
+	std::mutex _doneMutex;
+	std::condition_variable _doneCondition; // a counter has reached zero, or a task was queued
+
+	static thread_local int t_workerIndex;
+
+	void push(const Task& task);
+	bool popOrSteal(int self, Task& task);
+	void execute(const Task& task);
+	void workerLoop(int worker);
+
+public:
+	TaskScheduler() = default;
+	~TaskScheduler() { stop(); }
+
+	TaskScheduler(const TaskScheduler&) = delete;
+	TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+	// Spawns workers 1 to numWorkers - 1, each of which calls onWorkerStart(index) first
+	void start(int numWorkers, const std::function<void(int)>& onWorkerStart);
+	void stop();
+
+	int getNumWorkers() const { return std::max(1, static_cast<int>(_workers.size())); }
+	static int getWorkerIndex() { return t_workerIndex; }
+
+	// Queues run(context, begin, end) on the calling worker; 'pending' is decremented when it is done
+	void submit(RunFn run, const void* context, int begin, int end, Counter& pending);
+	// Runs queued tasks until 'pending' reaches zero
+	void wait(const Counter& pending);
+
+	// Calls fn(first, last) for consecutive chunks of at most 'grain' indices of [begin, end), spread
+	// over the workers, and returns when all are done. Without workers, or with a single chunk, the
+	// calling thread runs it directly.
+	template <typename Fn>
+	void parallelFor(int begin, int end, int grain, Fn&& fn)
+	{
+		if (begin >= end) return;
+		grain = std::max(grain, 1);
+		if (_workers.size() <= 1 || end - begin <= grain)
+		{
+			fn(begin, end);
+			return;
+		}
+
+		using Body = std::remove_reference_t<Fn>;
+		const RunFn run = [](const void* context, int first, int last) { (*static_cast<const Body*>(context))(first, last); };
+
+		const int numChunks = (end - begin + grain - 1) / grain;
+		Counter pending{ numChunks };
+		for (int first = begin; first < end; first += grain)
+		{
+			submit(run, &fn, first, std::min(first + grain, end), pending);
+		}
+		wait(pending);
+	}
+};
+
+// The jobs of one tick and the order between them. Each job runs once per run(), on whichever
+// worker is free, as soon as every job it depends on has finished; jobs without an order between
+// them may run at the same time. A job can split its own work further with parallelFor.
+class TaskGraph
+{
+private:
+	struct Node
+	{
+		std::function<void()> job;
+		std::vector<int> successors;
+		int numDependencies = 0;
+		std::atomic<int> pending{ 0 };
+	};
+
+	std::vector<std::unique_ptr<Node>> _nodes;
+	TaskScheduler* _scheduler = nullptr; // while running
+	TaskScheduler::Counter _remaining{ 0 };
+
+	static void runNode(const void* context, int node, int);
+
+public:
+	// Returns the job's index, to name it as a dependency of later jobs
+	int add(std::function<void()> job, std::initializer_list<int> dependencies = {});
+	void clear() { _nodes.clear(); }
+	bool isEmpty() const { return _nodes.empty(); }
+
+	// Runs every job once and returns when all have finished
+	void run(TaskScheduler& scheduler);
+};
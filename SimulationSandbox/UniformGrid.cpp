@@ -0,0 +1,77 @@
+#include "UniformGrid.h"
+#include <algorithm>
+#include <cmath>
+
+void UniformGrid::init(float cellSize, const DirectX::XMFLOAT3& worldMin, const DirectX::XMFLOAT3& worldMax, int numThreads)
+{
+	_cellSize = cellSize;
+	_inverseCellSize = 1.0f / cellSize;
+	_worldMin = worldMin;
+	_worldMax = worldMax;
+
+	DirectX::XMFLOAT3 worldSize = { worldMax.x - worldMin.x, worldMax.y - worldMin.y, worldMax.z - worldMin.z };
+	_cellsX = std::max(1, static_cast<int>(ceil(worldSize.x / _cellSize)));
+	_cellsY = std::max(1, static_cast<int>(ceil(worldSize.y / _cellSize)));
+	_cellsZ = std::max(1, static_cast<int>(ceil(worldSize.z / _cellSize)));
+
+	size_t totalCells = (size_t)_cellsX * _cellsY * _cellsZ;
+	_sort.init(totalCells, numThreads);
+}
+
+void UniformGrid::getCellCoords(float x, float y, float z, int& cellX, int& cellY, int& cellZ) const
+{
+	// Bodies that slipped out of the world are kept in the border cells
+	x = std::clamp(x, _worldMin.x, _worldMax.x - 0.001f);
+	y = std::clamp(y, _worldMin.y, _worldMax.y - 0.001f);
+	z = std::clamp(z, _worldMin.z, _worldMax.z - 0.001f);
+	cellX = std::min(static_cast<int>((x - _worldMin.x) * _inverseCellSize), _cellsX - 1);
+	cellY = std::min(static_cast<int>((y - _worldMin.y) * _inverseCellSize), _cellsY - 1);
+	cellZ = std::min(static_cast<int>((z - _worldMin.z) * _inverseCellSize), _cellsZ - 1);
+}
+
+int UniformGrid::getCellIndex(float x, float y, float z) const
+{
+	int cellX, cellY, cellZ;
+	getCellCoords(x, y, z, cellX, cellY, cellZ);
+	return getCellIndex(cellX, cellY, cellZ);
+}
+
+void UniformGrid::countBodies(const BodyStore& bodies, int begin, int end, int threadIndex)
+{
+	_sort.count(begin, end, threadIndex, bodies.size(), [&](int i) { return getCellIndex(bodies.posX[i], bodies.posY[i], bodies.posZ[i]); });
+}
+
+void UniformGrid::scatterBodies(const BodyStore& bodies, int begin, int end, int threadIndex)
+{
+	_sort.scatter(begin, end, threadIndex, [&](int i) { return getCellIndex(bodies.posX[i], bodies.posY[i], bodies.posZ[i]); });
+}
+
+void UniformGrid::build(const BodyStore& bodies)
+{
+	_sort.build(bodies.size(), [&](int i) { return getCellIndex(bodies.posX[i], bodies.posY[i], bodies.posZ[i]); });
+}
+
+void UniformGrid::getCellRangeForBodies(int threadIndex, int numThreads, int& startCell, int& endCell) const
+{
+	// Cell starts are a prefix sum, so the cells starting in a slice of the sorted bodies form one run
+	const int numBodies = static_cast<int>(_sort.getNumItems());
+	const int numCells = static_cast<int>(_sort.getNumCells());
+	const int bodiesPerThread = (numBodies + numThreads - 1) / numThreads;
+	const int beginSlot = std::min(threadIndex * bodiesPerThread, numBodies);
+	const int endSlot = std::min(beginSlot + bodiesPerThread, numBodies);
+
+	auto firstCellAt = [&](int slot)
+		{
+			int low = 0, high = numCells;
+			while (low < high)
+			{
+				int mid = (low + high) / 2;
+				if (_sort.getCellStart(mid) < slot) low = mid + 1;
+				else high = mid;
+			}
+			return low;
+		};
+
+	startCell = firstCellAt(beginSlot);
+	endCell = endSlot == numBodies ? numCells : firstCellAt(endSlot);
+}
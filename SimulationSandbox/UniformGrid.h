@@ -0,0 +1,122 @@
+#pragma once
+#include <vector>
+#include <DirectXMath.h>
+#include "BodyStore.h"
+#include "CellSort.h"
+
+// Dense uniform grid rebuilt every tick with a counting sort (see CellSort).
+// The body store must not change during a build. The build is split into passes,
+// each split into slots that run in parallel:
+//   countBodies -> sumCells -> assignOffsets -> scatterBodies
+class UniformGrid
+{
+private:
+	int _cellsX = 0;
+	int _cellsY = 0;
+	int _cellsZ = 0;
+	float _cellSize = 0.0f;
+	float _inverseCellSize = 0.0f;
+	DirectX::XMFLOAT3 _worldMin = { 0.0f, 0.0f, 0.0f };
+	DirectX::XMFLOAT3 _worldMax = { 0.0f, 0.0f, 0.0f };
+
+	CellSort _sort; // body store indices sorted by cell
+
+	// Half of the 26 neighbour offsets, one of each opposite pair
+	static constexpr int FORWARD_NEIGHBOURS[13][3] = {
+		{ 1, 0, 0 },
+		{ -1, 1, 0 }, { 0, 1, 0 }, { 1, 1, 0 },
+		{ -1, -1, 1 }, { 0, -1, 1 }, { 1, -1, 1 },
+		{ -1, 0, 1 }, { 0, 0, 1 }, { 1, 0, 1 },
+		{ -1, 1, 1 }, { 0, 1, 1 }, { 1, 1, 1 } };
+
+	void getCellRangeForBodies(int threadIndex, int numThreads, int& startCell, int& endCell) const;
+
+public:
+	void init(float cellSize, const DirectX::XMFLOAT3& worldMin, const DirectX::XMFLOAT3& worldMax, int numThreads);
+
+	// Pass 1: per-thread histogram over the body range [begin, end)
+	void countBodies(const BodyStore& bodies, int begin, int end, int threadIndex);
+	// Pass 2: prefix sum over the cells
+	void sumCells(int threadIndex, int numThreads) { _sort.sumCells(threadIndex, numThreads); }
+	void assignOffsets(int threadIndex, int numThreads) { _sort.assignOffsets(threadIndex, numThreads); }
+	// Pass 3: write body indices into their cell's run
+	void scatterBodies(const BodyStore& bodies, int begin, int end, int threadIndex);
+
+	void build(const BodyStore& bodies); // single-threaded convenience, runs all passes
+
+	int getCellIndex(float x, float y, float z) const;
+	void getCellCoords(float x, float y, float z, int& cellX, int& cellY, int& cellZ) const;
+	int getCellIndex(int cellX, int cellY, int cellZ) const { return cellX + cellY * _cellsX + cellZ * _cellsX * _cellsY; }
+	bool isInside(int cellX, int cellY, int cellZ) const
+	{
+		return cellX >= 0 && cellX < _cellsX && cellY >= 0 && cellY < _cellsY && cellZ >= 0 && cellZ < _cellsZ;
+	}
+
+	// Calls fn(j) for every body j > i in the 3x3x3 cells around (x, y, z)
+	template <typename Fn>
+	void forEachNeighbour(int i, float x, float y, float z, Fn&& fn) const
+	{
+		int centerCellX, centerCellY, centerCellZ;
+		getCellCoords(x, y, z, centerCellX, centerCellY, centerCellZ);
+
+		for (int dz = -1; dz <= 1; ++dz) for (int dy = -1; dy <= 1; ++dy) for (int dx = -1; dx <= 1; ++dx)
+		{
+			int cellX = centerCellX + dx, cellY = centerCellY + dy, cellZ = centerCellZ + dz;
+			if (!isInside(cellX, cellY, cellZ)) continue;
+
+			int cell = getCellIndex(cellX, cellY, cellZ);
+			const int* cellBodies = _sort.getCellItems(cell);
+			const int cellCount = _sort.getCellCount(cell);
+			for (int k = 0; k < cellCount; ++k)
+			{
+				if (i < cellBodies[k]) fn(cellBodies[k]);
+			}
+		}
+	}
+
+	// Calls fn(a, b) once for every pair of bodies in the same or adjacent cells: pairs within a
+	// cell, then pairs with the 13 "forward" neighbours, so no pair needs an index comparison.
+	// Threads split the sorted bodies evenly and each takes the cells that start in its slice.
+	template <typename Fn>
+	void forEachCellPair(int threadIndex, int numThreads, Fn&& fn) const
+	{
+		int startCell, endCell;
+		getCellRangeForBodies(threadIndex, numThreads, startCell, endCell);
+
+		for (int cell = startCell; cell < endCell; ++cell)
+		{
+			const int cellCount = _sort.getCellCount(cell);
+			if (cellCount == 0) continue;
+			const int* cellBodies = _sort.getCellItems(cell);
+
+			for (int k = 0; k < cellCount; ++k)
+				for (int l = k + 1; l < cellCount; ++l)
+					fn(cellBodies[k], cellBodies[l]);
+
+			const int cellX = cell % _cellsX;
+			const int cellY = (cell / _cellsX) % _cellsY;
+			const int cellZ = cell / (_cellsX * _cellsY);
+			for (const auto& offset : FORWARD_NEIGHBOURS)
+			{
+				const int otherX = cellX + offset[0], otherY = cellY + offset[1], otherZ = cellZ + offset[2];
+				if (!isInside(otherX, otherY, otherZ)) continue;
+
+				const int other = getCellIndex(otherX, otherY, otherZ);
+				const int otherCount = _sort.getCellCount(other);
+				const int* otherBodies = _sort.getCellItems(other);
+				for (int k = 0; k < cellCount; ++k)
+					for (int l = 0; l < otherCount; ++l)
+						fn(cellBodies[k], otherBodies[l]);
+			}
+		}
+	}
+
+	int getCellCount(int cell) const { return _sort.getCellCount(cell); }
+	const int* getCellBodies(int cell) const { return _sort.getCellItems(cell); }
+
+	size_t getNumCells() const { return _sort.getNumCells(); }
+	int getCellsX() const { return _cellsX; }
+	int getCellsY() const { return _cellsY; }
+	int getCellsZ() const { return _cellsZ; }
+	float getCellSize() const { return _cellSize; }
+};
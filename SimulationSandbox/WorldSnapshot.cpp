@@ -0,0 +1,31 @@
+#include "WorldSnapshot.h"
+
+DirectX::XMMATRIX BodySnapshot::getWorldMatrix() const
+{
+	DirectX::XMMATRIX scaleMatrix = DirectX::XMMatrixScaling(radius, radius, radius);
+	DirectX::XMVECTOR quaternion = DirectX::XMQuaternionRotationRollPitchYaw(
+		DirectX::XMConvertToRadians(rotation.x),
+		DirectX::XMConvertToRadians(rotation.y),
+		DirectX::XMConvertToRadians(rotation.z)
+	);
+	DirectX::XMMATRIX rotationMatrix = DirectX::XMMatrixRotationQuaternion(quaternion);
+	DirectX::XMMATRIX translationMatrix = DirectX::XMMatrixTranslation(position.x, position.y, position.z);
+
+	return scaleMatrix * rotationMatrix * translationMatrix;
+}
+
+void SnapshotBuffer::publish()
+{
+	// Release: the reader that takes this snapshot sees everything written into it
+	const uint8_t previous = _spare.exchange(_writeIndex | NEW_FLAG, std::memory_order_acq_rel);
+	_writeIndex = previous & INDEX_MASK;
+}
+
+bool SnapshotBuffer::acquire()
+{
+	if ((_spare.load(std::memory_order_relaxed) & NEW_FLAG) == 0) return false;
+
+	const uint8_t previous = _spare.exchange(_readIndex, std::memory_order_acq_rel);
+	_readIndex = previous & INDEX_MASK;
+	return true;
+}
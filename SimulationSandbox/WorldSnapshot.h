@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <DirectXMath.h>
+
+// What the renderer needs of a moving body, copied out of the body store at the end of a tick
+struct BodySnapshot
+{
+	int objectId;
+	DirectX::XMFLOAT3 position;
+	DirectX::XMFLOAT3 rotation; // euler angles in degrees, same as Collider
+	float radius;               // the sphere's scale on every axis
+	DirectX::XMFLOAT4 lightColour;
+	DirectX::XMFLOAT4 darkColour;
+
+	// Same transform as Collider::updateWorldMatrix
+	DirectX::XMMATRIX getWorldMatrix() const;
+};
+
+struct WorldSnapshot
+{
+	std::vector<BodySnapshot> bodies; // in body store order
+};
+
+// Triple buffer of world snapshots between the tick thread (writer) and the render thread (reader).
+// The writer fills its own snapshot and swaps it with the spare one, the reader swaps the spare one
+// with its own whenever the writer has published since; neither ever waits for the other, and the
+// reader keeps its snapshot for as long as it likes. One writer and one reader only.
+class SnapshotBuffer
+{
+private:
+	static constexpr uint8_t INDEX_MASK = 0x3;
+	static constexpr uint8_t NEW_FLAG = 0x4; // the spare snapshot was published after the reader last took one
+
+	WorldSnapshot _snapshots[3];
+	uint8_t _writeIndex = 0;
+	std::atomic<uint8_t> _spare{ 1 };
+	uint8_t _readIndex = 2;
+
+public:
+	// Writer: the snapshot to fill, left as it was two publishes ago so its storage is reused
+	WorldSnapshot& beginWrite() { return _snapshots[_writeIndex]; }
+	void publish();
+
+	// Reader: swaps in the newest snapshot, if there is one, and returns true if it did
+	bool acquire();
+	const WorldSnapshot& getRead() const { return _snapshots[_readIndex]; }
+};
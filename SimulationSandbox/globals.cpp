@@ -18,4 +18,5 @@ namespace globals
 	std::atomic<float> actualSimFrequencyHz{ 0.0f };
 	std::atomic<float> actualGfxFrequencyHz{ 0.0f };
 	std::atomic<float> actualNetFrequencyHz{ 0.0f };
+	std::atomic<float> realTimeFactor{ 0.0f };
 }
\ No newline at end of file
@@ -24,4 +24,5 @@ namespace globals
     extern std::atomic<float> actualSimFrequencyHz;
     extern std::atomic<float> actualGfxFrequencyHz;
     extern std::atomic<float> actualNetFrequencyHz;
+    extern std::atomic<float> realTimeFactor;     // simulated seconds per wall-clock second
 }
\ No newline at end of file